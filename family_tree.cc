@@ -1,9 +1,22 @@
 /**
  * <Copyright Nattaphoom Ch.>
  */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <list>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 using std::cin;
 using std::string;
@@ -14,24 +27,138 @@ bool SuperReplace(string &str, const string &from, const string &to);
 void SuperTrim(string &str);
 void Trim(string &str);
 void PrintHeader(string str);
+void ReadLine(string &str);
+void AppendFormat(string *out, const char *format, ...);
 
 const char kFemale[] = "female";
 const char kMale[] = "male";
 const char kNotIdentified[] = "not identified";
 
-// 6 major commands
+// 9 major commands
 const int kUnknownCommand = -187;
 const int kAddNewPerson = 1001;
 const int kDeletePerson = 1002;
 const int kFindAndDisplayPerson = 1003;
 const int kShowAllRelatives = 1004;
 const int kQuitProgram = 1005;
+const int kShowStatistics = 1006;
+const int kExportFamilyTree = 1007;
+const int kImportGedcomFile = 1008;
+
+// Instrumentation is on by default, build with -DFAMILY_TREE_NO_STATS
+// to compile all of it out.
+#ifndef FAMILY_TREE_NO_STATS
+#define FAMILY_TREE_STATS
+#endif
+
+#ifdef FAMILY_TREE_STATS
+
+// Only the commands that touch the family tree are timed.
+const int kFirstTimedCommand = kAddNewPerson;
+const int kTimedCommandCount = 4;
+const char *const kTimedCommandNames[kTimedCommandCount] = {
+    "add", "delete", "find", "relatives"
+};
+
+// Every power of two is split into 2^kLatencySubBucketBits linear buckets,
+// i.e., about 3% relative error for any recorded latency.
+const int kLatencySubBucketBits = 5;
+const int kLatencySubBuckets = 1 << kLatencySubBucketBits;
+const int kLatencyBuckets = (64 - kLatencySubBucketBits + 1) *
+                            kLatencySubBuckets;
+
+/**
+ * HDR-style latency histogram of nanosecond values.
+ * Recording is O(1) and never allocates.
+ */
+class LatencyHistogram {
+    public:
+        LatencyHistogram();
+        void Record(uint64_t value);
+        uint64_t ValueAtPercentile(double percentile);
+        uint64_t count();
+        uint64_t max();
+        uint64_t mean();
+    private:
+        static int BucketOf(uint64_t value);
+        static uint64_t HighestValueOf(int bucket);
+        uint64_t counts_[kLatencyBuckets];
+        uint64_t count_;
+        uint64_t total_;
+        uint64_t max_;
+};
+
+/**
+ * Work counters of the family tree lookups.
+ */
+struct QueryCounters {
+    uint64_t get_calls;
+    uint64_t nodes_visited;
+    uint64_t comparisons;
+    uint64_t relatives_cache_hits;
+    uint64_t relatives_cache_misses;
+};
+
+/**
+ * Latency and the total work done by one kind of command.
+ */
+struct CommandStats {
+    LatencyHistogram latency;
+    QueryCounters work;
+};
+
+/**
+ * All of the instrumentation of the program.
+ * `counters` are running totals, `input_wait` is the nanoseconds spent
+ * waiting for the user, which is not counted as command latency.
+ */
+struct FamilyTreeStats {
+    QueryCounters counters;
+    uint64_t input_wait;
+    CommandStats commands[kTimedCommandCount];
+};
+
+FamilyTreeStats family_tree_stats;
+
+/**
+ * Times a command from construction to destruction and charges
+ * the counters it moved to the command.
+ */
+class CommandTimer {
+    public:
+        explicit CommandTimer(int command);
+        ~CommandTimer();
+    private:
+        int command_;
+        std::chrono::steady_clock::time_point start_;
+        uint64_t input_wait_start_;
+        QueryCounters counters_start_;
+};
+
+#define STATS_COUNT(counter) (++family_tree_stats.counters.counter)
+#define STATS_TIME_COMMAND(command) CommandTimer command_timer(command)
+
+#else
+
+#define STATS_COUNT(counter) ((void)0)
+#define STATS_TIME_COMMAND(command) ((void)0)
+
+#endif  // FAMILY_TREE_STATS
+
+/**
+ * Returns `c` in lower case, ASCII letters only, so every case
+ * insensitive comparison and hash agrees regardless of the locale.
+ */
+inline unsigned char FoldCase(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
 
 /**
  * Compares two strings, ignore the case and "not identified" too.
  * Returns true if `str1` and `str2` is the same (case insensitive).
  */
 bool EqualsIgnoreCase(const string &str1, const string &str2) {
+    STATS_COUNT(comparisons);
     // "not identified" cannot compare, returns false by default
     if (str1.compare(kNotIdentified) == 0 ||
         str2.compare(kNotIdentified) == 0) {
@@ -43,7 +170,7 @@ bool EqualsIgnoreCase(const string &str1, const string &str2) {
     for (string::const_iterator c1 = str1.begin(), c2 = str2.begin();
             c1 != str1.end();
             ++c1, ++c2) {
-        if (tolower(*c1) != tolower(*c2)) {
+        if (FoldCase(*c1) != FoldCase(*c2)) {
             return false;
         }
     }
@@ -137,422 +264,2834 @@ void PrintHeader(string str) {
 }
 
 /**
- * Class prototype for person.
- * Each person has the following details:
- * full name, age, gender, father's full name and mother's full name.
+ * Reads a line from standard input into `str`.
+ * The time spent waiting for the user is excluded from command latency.
  */
-class Person {
+void ReadLine(string &str) {
+#ifdef FAMILY_TREE_STATS
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    getline(cin, str);
+    family_tree_stats.input_wait +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+#else
+    getline(cin, str);
+#endif
+}
+
+/**
+ * Appends the printf style `format` to `out`.
+ */
+void AppendFormat(string *out, const char *format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if (length < static_cast<int>(sizeof(buffer))) {
+        out->append(buffer, length);
+        return;
+    }
+    // Too long for the buffer, format again straight into `out`.
+    size_t old_size = out->size();
+    out->resize(old_size + length + 1);
+    va_start(args, format);
+    vsnprintf(&(*out)[old_size], length + 1, format, args);
+    va_end(args);
+    out->resize(old_size + length);
+}
+
+#ifdef FAMILY_TREE_STATS
+
+/**
+ * Constructs empty histogram.
+ */
+LatencyHistogram::LatencyHistogram() {
+    for (int i = 0; i < kLatencyBuckets; i++) {
+        counts_[i] = 0;
+    }
+    count_ = 0;
+    total_ = 0;
+    max_ = 0;
+}
+
+/**
+ * Returns the bucket of `value`. Values below kLatencySubBuckets are exact,
+ * the rest keep only their kLatencySubBucketBits most significant bits.
+ */
+int LatencyHistogram::BucketOf(uint64_t value) {
+    if (value < kLatencySubBuckets) {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kLatencySubBucketBits;
+    int sub_bucket = static_cast<int>(value >> shift) - kLatencySubBuckets;
+    return (shift + 1) * kLatencySubBuckets + sub_bucket;
+}
+
+/**
+ * Returns the highest value which falls into `bucket`.
+ */
+uint64_t LatencyHistogram::HighestValueOf(int bucket) {
+    if (bucket < kLatencySubBuckets) {
+        return bucket;
+    }
+    int shift = bucket / kLatencySubBuckets - 1;
+    uint64_t sub_bucket = kLatencySubBuckets + bucket % kLatencySubBuckets;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+/**
+ * Records one `value` into the histogram.
+ */
+void LatencyHistogram::Record(uint64_t value) {
+    counts_[BucketOf(value)]++;
+    count_++;
+    total_ += value;
+    if (value > max_) {
+        max_ = value;
+    }
+}
+
+/**
+ * Returns the value that `percentile` percent of the recorded values are
+ * less than or equal to, within the precision of the buckets.
+ */
+uint64_t LatencyHistogram::ValueAtPercentile(double percentile) {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < kLatencyBuckets; i++) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            uint64_t value = HighestValueOf(i);
+            return value < max_ ? value : max_;
+        }
+    }
+    return max_;
+}
+
+/**
+ * Returns the number of recorded values.
+ */
+uint64_t LatencyHistogram::count() {
+    return count_;
+}
+
+/**
+ * Returns the largest recorded value.
+ */
+uint64_t LatencyHistogram::max() {
+    return max_;
+}
+
+/**
+ * Returns the mean of the recorded values.
+ */
+uint64_t LatencyHistogram::mean() {
+    return count_ == 0 ? 0 : total_ / count_;
+}
+
+/**
+ * Starts timing `command`.
+ */
+CommandTimer::CommandTimer(int command) {
+    command_ = command;
+    input_wait_start_ = family_tree_stats.input_wait;
+    counters_start_ = family_tree_stats.counters;
+    start_ = std::chrono::steady_clock::now();
+}
+
+/**
+ * Records the latency of the command, minus the time spent waiting for
+ * the user, and the work it has done.
+ */
+CommandTimer::~CommandTimer() {
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    uint64_t input_wait = family_tree_stats.input_wait - input_wait_start_;
+    CommandStats &stats =
+        family_tree_stats.commands[command_ - kFirstTimedCommand];
+    stats.latency.Record(elapsed > input_wait ? elapsed - input_wait : 0);
+    const QueryCounters &counters = family_tree_stats.counters;
+    stats.work.get_calls += counters.get_calls - counters_start_.get_calls;
+    stats.work.nodes_visited +=
+        counters.nodes_visited - counters_start_.nodes_visited;
+    stats.work.comparisons +=
+        counters.comparisons - counters_start_.comparisons;
+}
+
+#endif  // FAMILY_TREE_STATS
+
+/**
+ * Handle of a name in the global NamePool.
+ */
+typedef uint32_t NameHandle;
+
+// "not identified" is always the first name in the pool.
+const NameHandle kNotIdentifiedName = 0;
+// Returned by NamePool::Find for the names which are not in the pool.
+const NameHandle kUnknownName = 0xFFFFFFFF;
+// Surname id of the names without surname.
+const uint32_t kNoSurname = 0xFFFFFFFF;
+// Set in NamePool::Entry::given_name for the names which equal an
+// earlier name ignoring case.
+const uint32_t kCaseVariant = 0x80000000u;
+
+/**
+ * Class prototype for the pool of names.
+ * Every distinct name is stored once and referred by a 32-bit handle.
+ * A name is split at its last space into a given name and a surname,
+ * surnames are dictionary encoded since the whole family shares them.
+ * Names are never removed from the pool.
+ */
+class NamePool {
     public:
-        Person();
-        Person(string full_name, unsigned int age, string gender,
-                string father_full_name, string mother_full_name);
-        int age();
-        string full_name();
-        string gender();
-        string father_full_name();
-        void set_father_full_name(string father_full_name);
-        string mother_full_name();
-        void set_mother_full_name(string mother_full_name);
-        string ToString();
+        NamePool();
+        NameHandle Intern(const string &name);
+        static uint32_t FoldedHash(const char *name, size_t length);
+        NameHandle Lookup(const char *name, size_t length, uint32_t hash,
+                NameHandle *folded);
+        NameHandle Add(const char *name, size_t length, uint32_t hash,
+                NameHandle folded);
+        void Reserve(size_t names);
+        NameHandle Find(const string &name);
+        string Get(NameHandle handle);
+        const char *GivenName(NameHandle handle);
+        const char *Surname(NameHandle handle);
+        NameHandle Folded(NameHandle handle);
+        bool Equals(NameHandle handle1, NameHandle handle2);
+        size_t size();
+        size_t surnames();
+        size_t bytes();
     private:
-        string full_name_;
-        unsigned int age_;
-        string gender_;
-        string father_full_name_;
-        string mother_full_name_;
+        struct Entry {
+            // Offset of the NUL terminated given name in given_names_,
+            // or'ed with kCaseVariant.
+            uint32_t given_name;
+            uint32_t surname;
+        };
+        static uint32_t Hash(uint32_t hash, const char *str, size_t length,
+                bool ignore_case);
+        static void Insert(std::vector<uint32_t> *slots, uint32_t hash,
+                uint32_t value);
+        static bool IsFull(size_t size, size_t slots);
+        uint32_t FoldedHashOf(NameHandle handle);
+        bool Matches(NameHandle handle, const char *name, size_t length,
+                bool ignore_case);
+        uint32_t InternSurname(const char *surname, size_t length);
+        void Rehash(size_t slots);
+        void Grow();
+        std::vector<char> given_names_;
+        std::vector<Entry> entries_;
+        // The first interned name which equals ignoring case, for the
+        // names with kCaseVariant only.
+        std::unordered_map<NameHandle, NameHandle> case_variants_;
+        std::vector<char> surname_bytes_;
+        std::vector<uint32_t> surname_offsets_;
+        // Open addressing hash tables, each slot holds handle + 1,
+        // 0 is an empty slot. The names are hashed ignoring case, so
+        // a name and its case variants are in the same probe sequence.
+        std::vector<uint32_t> name_slots_;
+        std::vector<uint32_t> surname_slots_;
 };
 
+// FNV-1a parameters.
+const uint32_t kHashOffsetBasis = 2166136261u;
+const uint32_t kHashPrime = 16777619u;
+const size_t kInitialNameSlots = 1024;
+
 /**
- * Default constructor of person.
- * Initialise all of the string member variables with "not identified"
- * and age_ with 0.
+ * Returns the slot of `hash` in a hash table of `slots` slots, which
+ * need not be a power of two.
  */
-Person::Person() {
-    full_name_ = kNotIdentified;
-    age_ = 0;
-    gender_ = kNotIdentified;
-    father_full_name_ = kNotIdentified;
-    mother_full_name_ = kNotIdentified;
+inline size_t SlotOf(uint32_t hash, size_t slots) {
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * slots) >> 32);
 }
 
 /**
- * Constructs a person from the given `full_name`, `age`,
- * `gender`, `father_full_name`, `mother_full_name`.
- * If `father_full_name` or `mother_full_name` is empty string
- * it will replace with "not identified" by default.
+ * Returns the slot after `slot` in a hash table of `slots` slots.
  */
-Person::Person(string full_name, unsigned int age, string gender,
-        string father_full_name, string mother_full_name) {
-    full_name_ = full_name;
-    age_ = age;
-    gender_ = gender;
-    father_full_name_ = father_full_name;
-    mother_full_name_ = mother_full_name;
-    if (father_full_name.compare("") == 0) {
-        father_full_name_ = kNotIdentified;
+inline size_t NextSlot(size_t slot, size_t slots) {
+    return slot + 1 == slots ? 0 : slot + 1;
+}
+
+/**
+ * Makes room for `extra` more elements at the end of `vector`. The pool
+ * holds a few bytes per name, so it grows by 1/8 instead of doubling.
+ */
+template <typename T>
+void ReserveGradually(std::vector<T> *vector, size_t extra) {
+    if (vector->size() + extra > vector->capacity()) {
+        vector->reserve(vector->size() + extra + vector->size() / 8);
     }
-    if (mother_full_name.compare("") == 0) {
-        mother_full_name_ = kNotIdentified;
+}
+
+/**
+ * Constructs the pool with "not identified" only.
+ */
+NamePool::NamePool() {
+    name_slots_.assign(kInitialNameSlots, 0);
+    surname_slots_.assign(kInitialNameSlots, 0);
+    Intern(kNotIdentified);
+}
+
+/**
+ * Continues the FNV-1a `hash` with `length` bytes of `str`.
+ */
+uint32_t NamePool::Hash(uint32_t hash, const char *str, size_t length,
+        bool ignore_case) {
+    size_t i;
+    for (i = 0; i < length; i++) {
+        unsigned char c = str[i];
+        hash ^= ignore_case ? FoldCase(c) : c;
+        hash *= kHashPrime;
     }
+    return hash;
 }
 
 /**
- * Returns age of the person.
+ * Puts `value` + 1 into the first empty slot of `slots` from `hash`.
  */
-int Person::age() {
-    return age_;
+void NamePool::Insert(std::vector<uint32_t> *slots, uint32_t hash,
+        uint32_t value) {
+    size_t slot = SlotOf(hash, slots->size());
+    while ((*slots)[slot] != 0) {
+        slot = NextSlot(slot, slots->size());
+    }
+    (*slots)[slot] = value + 1;
 }
 
 /**
- * Returns full name of the person.
+ * Returns true if a hash table of `slots` slots holding `size` values
+ * is more than 2/3 full.
  */
-string Person::full_name() {
-    return full_name_;
+bool NamePool::IsFull(size_t size, size_t slots) {
+    return size * 3 > slots * 2;
 }
 
 /**
- * Returns gender of the person.
+ * Returns the hash ignoring case of the full name of `handle`, the same
+ * as the hash of the string it is interned from.
  */
-string Person::gender() {
-    return gender_;
+uint32_t NamePool::FoldedHashOf(NameHandle handle) {
+    const char *given_name = GivenName(handle);
+    uint32_t hash = Hash(kHashOffsetBasis, given_name, strlen(given_name),
+            true);
+    if (entries_[handle].surname != kNoSurname) {
+        const char *surname = Surname(handle);
+        hash = Hash(hash, " ", 1, true);
+        hash = Hash(hash, surname, strlen(surname), true);
+    }
+    return hash;
 }
 
 /**
- * Returns father's full name of the person.
+ * Returns the hash ignoring case of `name` of `length` bytes, which
+ * Lookup and Add take.
  */
-string Person::father_full_name() {
-    return father_full_name_;
+uint32_t NamePool::FoldedHash(const char *name, size_t length) {
+    return Hash(kHashOffsetBasis, name, length, true);
 }
 
 /**
- * Changes father's full name of the person from the
- * given `father_full_name`.
+ * Returns true if the name of `handle` is `name` of `length` bytes.
  */
-void Person::set_father_full_name(string father_full_name) {
-    father_full_name_ = father_full_name;
+bool NamePool::Matches(NameHandle handle, const char *name, size_t length,
+        bool ignore_case) {
+    const char *given_name = GivenName(handle);
+    size_t given_length = strlen(given_name);
+    const char *surname = "";
+    size_t surname_length = 0;
+    if (entries_[handle].surname != kNoSurname) {
+        surname = Surname(handle);
+        surname_length = strlen(surname);
+        if (length != given_length + 1 + surname_length ||
+                name[given_length] != ' ') {
+            return false;
+        }
+    } else if (length != given_length) {
+        return false;
+    }
+    size_t i;
+    for (i = 0; i < given_length; i++) {
+        if (ignore_case ? FoldCase(name[i]) != FoldCase(given_name[i])
+                        : name[i] != given_name[i]) {
+            return false;
+        }
+    }
+    const char *name_surname = name + given_length + 1;
+    for (i = 0; i < surname_length; i++) {
+        if (ignore_case ? FoldCase(name_surname[i]) != FoldCase(surname[i])
+                        : name_surname[i] != surname[i]) {
+            return false;
+        }
+    }
+    return true;
 }
 
 /**
- * Returns mother's full name of the person.
+ * Returns the id of `surname`, adds it to the dictionary if needed.
  */
-string Person::mother_full_name() {
-    return mother_full_name_;
+uint32_t NamePool::InternSurname(const char *surname, size_t length) {
+    uint32_t hash = Hash(kHashOffsetBasis, surname, length, false);
+    size_t slot = SlotOf(hash, surname_slots_.size());
+    while (surname_slots_[slot] != 0) {
+        uint32_t id = surname_slots_[slot] - 1;
+        const char *other = &surname_bytes_[surname_offsets_[id]];
+        if (strncmp(other, surname, length) == 0 && other[length] == '\0') {
+            return id;
+        }
+        slot = NextSlot(slot, surname_slots_.size());
+    }
+    uint32_t id = surname_offsets_.size();
+    ReserveGradually(&surname_offsets_, 1);
+    surname_offsets_.push_back(surname_bytes_.size());
+    ReserveGradually(&surname_bytes_, length + 1);
+    surname_bytes_.insert(surname_bytes_.end(), surname, surname + length);
+    surname_bytes_.push_back('\0');
+    surname_slots_[slot] = id + 1;
+    if (IsFull(surname_offsets_.size(), surname_slots_.size())) {
+        std::vector<uint32_t> slots(surname_slots_.size() * 3 / 2, 0);
+        for (id = 0; id < surname_offsets_.size(); id++) {
+            const char *name = &surname_bytes_[surname_offsets_[id]];
+            Insert(&slots, Hash(kHashOffsetBasis, name, strlen(name), false),
+                    id);
+        }
+        surname_slots_.swap(slots);
+    }
+    return surname_offsets_.size() - 1;
 }
 
 /**
- * Changes mother's full name of the person from the
- * given `mother_full_name`.
+ * Rebuilds the hash table of the names with `slots` slots.
  */
-void Person::set_mother_full_name(string mother_full_name) {
-    mother_full_name_ = mother_full_name;
+void NamePool::Rehash(size_t slots) {
+    std::vector<uint32_t> name_slots(slots, 0);
+    NameHandle handle;
+    for (handle = 0; handle < entries_.size(); handle++) {
+        Insert(&name_slots, FoldedHashOf(handle), handle);
+    }
+    name_slots_.swap(name_slots);
 }
 
 /**
- * Returns the representation of the person as a string.
- * The information includes all of the member variables.
+ * Grows the hash table of the names by half once it is 2/3 full.
  */
-string Person::ToString() {
-    std::stringstream ss;
-    ss << full_name_ << ", " << age_ << " years old, " << gender_ <<
-    ", father: " << father_full_name_ <<
-    ", mother: " << mother_full_name_;
-    return ss.str();
+void NamePool::Grow() {
+    if (IsFull(entries_.size(), name_slots_.size())) {
+        Rehash(name_slots_.size() * 3 / 2);
+    }
 }
 
 /**
- * Structure prototype for family node.
- * FamilyNode consists of Person object and
- * FamilyNode pointer point to the next node.
+ * Grows the hash table of the names at once, so that `names` names in
+ * total fit without growing it again.
  */
-struct FamilyNode {
-    Person person;
-    FamilyNode *next;
+void NamePool::Reserve(size_t names) {
+    size_t slots = name_slots_.size();
+    while (IsFull(names, slots)) {
+        slots = slots * 3 / 2;
+    }
+    if (slots != name_slots_.size()) {
+        Rehash(slots);
+    }
+}
 
-    int age() {
-        return person.age();
+/**
+ * Returns the handle of `name`, adds it to the pool if needed.
+ */
+NameHandle NamePool::Intern(const string &name) {
+    uint32_t hash = FoldedHash(name.data(), name.size());
+    NameHandle folded;
+    NameHandle handle = Lookup(name.data(), name.size(), hash, &folded);
+    if (handle != kUnknownName) {
+        return handle;
     }
-    string full_name() {
-        return person.full_name();
+    return Add(name.data(), name.size(), hash, folded);
+}
+
+/**
+ * Returns the handle of `name` of `length` bytes and FoldedHash `hash`,
+ * or kUnknownName if it is not in the pool. Then `folded` is set to the
+ * folded handle of a name which equals it ignoring case, or kUnknownName.
+ * The pool is only read, so threads may look up at once while no name
+ * is added.
+ */
+NameHandle NamePool::Lookup(const char *name, size_t length, uint32_t hash,
+        NameHandle *folded) {
+    *folded = kUnknownName;
+    size_t slot = SlotOf(hash, name_slots_.size());
+    while (name_slots_[slot] != 0) {
+        NameHandle other = name_slots_[slot] - 1;
+        if (Matches(other, name, length, true)) {
+            if (Matches(other, name, length, false)) {
+                return other;
+            }
+            // "not identified" never equals to any name, so no other
+            // name can fold into it.
+            if (other != kNotIdentifiedName && *folded == kUnknownName) {
+                *folded = Folded(other);
+            }
+        }
+        slot = NextSlot(slot, name_slots_.size());
     }
+    return kUnknownName;
+}
 
-    string father() {
-        return person.father_full_name();
+/**
+ * Adds `name` of `length` bytes and FoldedHash `hash`, which Lookup did
+ * not find, and returns its handle. `folded` is the folded handle of a
+ * name which equals it ignoring case, or kUnknownName.
+ */
+NameHandle NamePool::Add(const char *name, size_t length, uint32_t hash,
+        NameHandle folded) {
+    NameHandle handle = entries_.size();
+    Entry entry;
+    // Split at the last space, unless the name ends with it.
+    size_t surname_offset = length;
+    while (surname_offset > 0 && name[surname_offset - 1] != ' ') {
+        surname_offset--;
+    }
+    size_t given_length = length;
+    entry.surname = kNoSurname;
+    if (surname_offset > 0 && surname_offset < length) {
+        given_length = surname_offset - 1;
+        entry.surname = InternSurname(name + surname_offset,
+                length - surname_offset);
+    }
+    entry.given_name = given_names_.size();
+    ReserveGradually(&given_names_, given_length + 1);
+    given_names_.insert(given_names_.end(), name, name + given_length);
+    given_names_.push_back('\0');
+    if (folded != kUnknownName) {
+        entry.given_name |= kCaseVariant;
+        case_variants_[handle] = folded;
+    }
+    ReserveGradually(&entries_, 1);
+    entries_.push_back(entry);
+    Insert(&name_slots_, hash, handle);
+    Grow();
+    return handle;
+}
+
+/**
+ * Returns the folded handle of `name` without adding it to the pool,
+ * or kUnknownName if no name equals `name` ignoring case.
+ */
+NameHandle NamePool::Find(const string &name) {
+    if (name.compare(kNotIdentified) == 0) {
+        return kNotIdentifiedName;
     }
+    uint32_t hash = FoldedHash(name.data(), name.size());
+    size_t slot = SlotOf(hash, name_slots_.size());
+    while (name_slots_[slot] != 0) {
+        NameHandle other = name_slots_[slot] - 1;
+        if (other != kNotIdentifiedName &&
+                Matches(other, name.data(), name.size(), true)) {
+            return Folded(other);
+        }
+        slot = NextSlot(slot, name_slots_.size());
+    }
+    return kUnknownName;
+}
 
-    string mother() {
-        return person.mother_full_name();
+/**
+ * Returns the name of `handle`.
+ */
+string NamePool::Get(NameHandle handle) {
+    string name = GivenName(handle);
+    if (entries_[handle].surname != kNoSurname) {
+        name += ' ';
+        name += Surname(handle);
+    }
+    return name;
+}
+
+/**
+ * Returns the given name part of `handle`, the whole name if it has
+ * no surname.
+ */
+const char *NamePool::GivenName(NameHandle handle) {
+    return &given_names_[entries_[handle].given_name & ~kCaseVariant];
+}
+
+/**
+ * Returns the surname part of `handle`, empty string if none.
+ */
+const char *NamePool::Surname(NameHandle handle) {
+    if (entries_[handle].surname == kNoSurname) {
+        return "";
+    }
+    return &surname_bytes_[surname_offsets_[entries_[handle].surname]];
+}
+
+/**
+ * Returns the handle of the first interned name which equals to
+ * `handle` ignoring case, i.e., the identity of the person.
+ */
+NameHandle NamePool::Folded(NameHandle handle) {
+    if ((entries_[handle].given_name & kCaseVariant) == 0) {
+        return handle;
+    }
+    return case_variants_.find(handle)->second;
+}
+
+/**
+ * Compares two names like EqualsIgnoreCase does, in constant time.
+ */
+bool NamePool::Equals(NameHandle handle1, NameHandle handle2) {
+    STATS_COUNT(comparisons);
+    if (handle1 == kNotIdentifiedName || handle2 == kNotIdentifiedName) {
+        return false;
+    }
+    return handle1 == handle2 || Folded(handle1) == Folded(handle2);
+}
+
+/**
+ * Returns the number of names in the pool.
+ */
+size_t NamePool::size() {
+    return entries_.size();
+}
+
+/**
+ * Returns the number of distinct surnames.
+ */
+size_t NamePool::surnames() {
+    return surname_offsets_.size();
+}
+
+/**
+ * Returns the bytes allocated by the pool, about the node and the
+ * bucket of each case variant for case_variants_.
+ */
+size_t NamePool::bytes() {
+    return given_names_.capacity() + surname_bytes_.capacity() +
+        entries_.capacity() * sizeof(Entry) +
+        case_variants_.size() * (sizeof(void *) +
+                sizeof(std::pair<const NameHandle, NameHandle>)) +
+        case_variants_.bucket_count() * sizeof(void *) +
+        (surname_offsets_.capacity() + name_slots_.capacity() +
+         surname_slots_.capacity()) * sizeof(uint32_t);
+}
+
+NamePool name_pool;
+
+// Ages are kept in 16 bits.
+const int kMaxAge = 0xFFFF;
+
+// Genders are kept as a code, the strings are kFemale, kMale and
+// kNotIdentified.
+const uint8_t kGenderNotIdentified = 0;
+const uint8_t kGenderMale = 1;
+const uint8_t kGenderFemale = 2;
+
+/**
+ * Class prototype for person.
+ * Each person has the following details:
+ * full name, age, gender, father's full name and mother's full name.
+ * Names live in the name_pool, so a person is a 16 bytes record.
+ */
+class Person {
+    public:
+        Person();
+        Person(string full_name, unsigned int age, string gender,
+                string father_full_name, string mother_full_name);
+        Person(NameHandle full_name, unsigned int age, uint8_t gender,
+                NameHandle father_full_name, NameHandle mother_full_name);
+        int age();
+        string full_name();
+        NameHandle full_name_handle();
+        string gender();
+        uint8_t gender_code();
+        bool is_female();
+        string father_full_name();
+        NameHandle father_handle();
+        void set_father_full_name(string father_full_name);
+        string mother_full_name();
+        NameHandle mother_handle();
+        void set_mother_full_name(string mother_full_name);
+        string ToString();
+    private:
+        NameHandle full_name_;
+        NameHandle father_full_name_;
+        NameHandle mother_full_name_;
+        uint16_t age_;
+        uint8_t gender_;
+};
+
+static_assert(sizeof(Person) == 16, "Person must stay a 16 bytes record");
+
+/**
+ * Default constructor of person.
+ * Initialise all of the names and gender with "not identified"
+ * and age_ with 0.
+ */
+Person::Person() {
+    full_name_ = kNotIdentifiedName;
+    age_ = 0;
+    gender_ = kGenderNotIdentified;
+    father_full_name_ = kNotIdentifiedName;
+    mother_full_name_ = kNotIdentifiedName;
+}
+
+/**
+ * Constructs a person from the given `full_name`, `age`,
+ * `gender`, `father_full_name`, `mother_full_name`.
+ * If `father_full_name` or `mother_full_name` is empty string
+ * it will replace with "not identified" by default.
+ * `gender` other than male or female is "not identified".
+ */
+Person::Person(string full_name, unsigned int age, string gender,
+        string father_full_name, string mother_full_name) {
+    full_name_ = name_pool.Intern(full_name);
+    age_ = age;
+    gender_ = kGenderNotIdentified;
+    if (EqualsIgnoreCase(gender, kMale)) {
+        gender_ = kGenderMale;
+    } else if (EqualsIgnoreCase(gender, kFemale)) {
+        gender_ = kGenderFemale;
+    }
+    father_full_name_ = kNotIdentifiedName;
+    mother_full_name_ = kNotIdentifiedName;
+    if (father_full_name.compare("") != 0) {
+        father_full_name_ = name_pool.Intern(father_full_name);
+    }
+    if (mother_full_name.compare("") != 0) {
+        mother_full_name_ = name_pool.Intern(mother_full_name);
+    }
+}
+
+/**
+ * Constructs a person from names already in the name_pool and
+ * a gender code.
+ */
+Person::Person(NameHandle full_name, unsigned int age, uint8_t gender,
+        NameHandle father_full_name, NameHandle mother_full_name) {
+    full_name_ = full_name;
+    age_ = age;
+    gender_ = gender;
+    father_full_name_ = father_full_name;
+    mother_full_name_ = mother_full_name;
+}
+
+/**
+ * Returns age of the person.
+ */
+int Person::age() {
+    return age_;
+}
+
+/**
+ * Returns full name of the person.
+ */
+string Person::full_name() {
+    return name_pool.Get(full_name_);
+}
+
+/**
+ * Returns handle of the full name of the person.
+ */
+NameHandle Person::full_name_handle() {
+    return full_name_;
+}
+
+/**
+ * Returns gender of the person.
+ */
+string Person::gender() {
+    if (gender_ == kGenderMale) {
+        return kMale;
+    } else if (gender_ == kGenderFemale) {
+        return kFemale;
+    }
+    return kNotIdentified;
+}
+
+/**
+ * Returns gender of the person as kGenderMale, kGenderFemale or
+ * kGenderNotIdentified.
+ */
+uint8_t Person::gender_code() {
+    return gender_;
+}
+
+/**
+ * Returns true if the person is female.
+ */
+bool Person::is_female() {
+    return gender_ == kGenderFemale;
+}
+
+/**
+ * Returns father's full name of the person.
+ */
+string Person::father_full_name() {
+    return name_pool.Get(father_full_name_);
+}
+
+/**
+ * Returns handle of father's full name of the person.
+ */
+NameHandle Person::father_handle() {
+    return father_full_name_;
+}
+
+/**
+ * Changes father's full name of the person from the
+ * given `father_full_name`.
+ */
+void Person::set_father_full_name(string father_full_name) {
+    father_full_name_ = name_pool.Intern(father_full_name);
+}
+
+/**
+ * Returns mother's full name of the person.
+ */
+string Person::mother_full_name() {
+    return name_pool.Get(mother_full_name_);
+}
+
+/**
+ * Returns handle of mother's full name of the person.
+ */
+NameHandle Person::mother_handle() {
+    return mother_full_name_;
+}
+
+/**
+ * Changes mother's full name of the person from the
+ * given `mother_full_name`.
+ */
+void Person::set_mother_full_name(string mother_full_name) {
+    mother_full_name_ = name_pool.Intern(mother_full_name);
+}
+
+/**
+ * Returns the representation of the person as a string.
+ * The information includes all of the member variables.
+ */
+string Person::ToString() {
+    std::stringstream ss;
+    ss << full_name() << ", " << age_ << " years old, " << gender() <<
+    ", father: " << father_full_name() <<
+    ", mother: " << mother_full_name();
+    return ss.str();
+}
+
+/**
+ * Structure prototype for family node.
+ * FamilyNode consists of Person object and
+ * FamilyNode pointer point to the next node.
+ */
+struct FamilyNode {
+    Person person;
+    FamilyNode *next;
+
+    int age() {
+        return person.age();
+    }
+    string full_name() {
+        return person.full_name();
+    }
+
+    string father() {
+        return person.father_full_name();
+    }
+
+    string mother() {
+        return person.mother_full_name();
+    }
+
+    string sex() {
+        return person.gender();
+    }
+};
+
+// Number of nodes allocated at once by the linked list.
+const int kNodeBlockSize = 1024;
+
+// Number of people whose relatives are kept by each linked list.
+const int kRelativesCacheCapacity = 256;
+
+/**
+ * Class prototype for the least recently used cache of relatives.
+ * Keys are folded name handles, which identify a person in the
+ * family tree, values are the relatives as printed by PrintRelativesOf.
+ */
+class RelativesCache {
+    public:
+        RelativesCache();
+        bool Lookup(NameHandle key, string *relatives);
+        void Store(NameHandle key, const string &relatives);
+        void Erase(NameHandle key);
+        void Clear();
+        bool empty();
+    private:
+        typedef std::list<std::pair<NameHandle, string> > Entries;
+        // Most recently used entry first.
+        Entries entries_;
+        std::unordered_map<NameHandle, Entries::iterator> index_;
+};
+
+/**
+ * Constructs empty cache.
+ */
+RelativesCache::RelativesCache() {
+    index_.reserve(kRelativesCacheCapacity);
+}
+
+/**
+ * Copies the cached relatives of `key` to `relatives` and marks it as
+ * the most recently used.
+ * Returns false if `key` is not cached.
+ */
+bool RelativesCache::Lookup(NameHandle key, string *relatives) {
+    std::unordered_map<NameHandle, Entries::iterator>::iterator it =
+        index_.find(key);
+    if (it == index_.end()) {
+        return false;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    *relatives = it->second->second;
+    return true;
+}
+
+/**
+ * Caches `relatives` of `key`, evicts the least recently used entry
+ * when the cache is full.
+ */
+void RelativesCache::Store(NameHandle key, const string &relatives) {
+    Erase(key);
+    if (static_cast<int>(index_.size()) >= kRelativesCacheCapacity) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::make_pair(key, relatives));
+    index_[key] = entries_.begin();
+}
+
+/**
+ * Removes `key` from the cache, if any.
+ */
+void RelativesCache::Erase(NameHandle key) {
+    std::unordered_map<NameHandle, Entries::iterator>::iterator it =
+        index_.find(key);
+    if (it == index_.end()) {
+        return;
+    }
+    entries_.erase(it->second);
+    index_.erase(it);
+}
+
+/**
+ * Removes everything from the cache.
+ */
+void RelativesCache::Clear() {
+    entries_.clear();
+    index_.clear();
+}
+
+/**
+ * Returns true if nothing is cached.
+ */
+bool RelativesCache::empty() {
+    return index_.empty();
+}
+
+/**
+ * Class prototype for linked list of the family tree.
+ */
+class FamilyLinkedList {
+    public:
+        FamilyLinkedList();
+        ~FamilyLinkedList();
+        FamilyNode *Get(string full_name);
+        FamilyNode *Get(NameHandle full_name);
+        void AppendAncestors(NameHandle full_name, int level, string *out);
+        void AppendDescendants(NameHandle full_name, int level, string *out);
+        void AppendSiblings(NameHandle full_name, string *out);
+        void Add(Person p);
+        void AddBatch(const std::vector<Person> &people);
+        FamilyNode *Delete(string full_name);
+        void PrintAllNodes();
+        void PrintRelativesOf(string full_name);
+        int size();
+        FamilyNode *head_;
+    private:
+        void InvalidateRelativesAround(FamilyNode *node);
+        void InvalidateAncestors(FamilyNode *node,
+                std::unordered_set<NameHandle> *visited);
+        void InvalidateDescendants(NameHandle full_name,
+                std::unordered_set<NameHandle> *visited);
+        FamilyNode *NewNode();
+        void FreeNode(FamilyNode *node);
+        int size_;
+        RelativesCache relatives_cache_;
+        // Nodes are allocated kNodeBlockSize at a time, the deleted ones
+        // are kept in free_nodes_ for the next Add.
+        std::vector<FamilyNode *> node_blocks_;
+        FamilyNode *free_nodes_;
+};
+
+/**
+ * Constructs empty linked list.
+ */
+FamilyLinkedList::FamilyLinkedList() {
+    head_ = NULL;
+    size_ = 0;
+    free_nodes_ = NULL;
+}
+
+/**
+ * Destructor for FamilyLinkedList.
+ */
+FamilyLinkedList::~FamilyLinkedList() {
+    size_t i;
+    for (i = 0; i < node_blocks_.size(); i++) {
+        delete[] node_blocks_[i];
+    }
+    head_ = NULL;
+}
+
+/**
+ * Returns an unused node, allocates a new block of nodes if needed.
+ */
+FamilyNode *FamilyLinkedList::NewNode() {
+    if (free_nodes_ == NULL) {
+        FamilyNode *block = new FamilyNode[kNodeBlockSize];
+        node_blocks_.push_back(block);
+        int i;
+        for (i = kNodeBlockSize - 1; i >= 0; i--) {
+            block[i].next = free_nodes_;
+            free_nodes_ = &block[i];
+        }
+    }
+    FamilyNode *node = free_nodes_;
+    free_nodes_ = node->next;
+    return node;
+}
+
+/**
+ * Gives `node` back for the next NewNode.
+ */
+void FamilyLinkedList::FreeNode(FamilyNode *node) {
+    node->next = free_nodes_;
+    free_nodes_ = node;
+}
+
+/**
+ * Returns the FamilyNode from the given `full_name`.
+ */
+FamilyNode *FamilyLinkedList::Get(string full_name) {
+    NameHandle handle = name_pool.Find(full_name);
+    if (handle == kUnknownName) {
+        STATS_COUNT(get_calls);
+        return NULL;  // Nobody has ever had this name.
+    }
+    return Get(handle);
+}
+
+/**
+ * Returns the FamilyNode from the given `full_name` handle.
+ */
+FamilyNode *FamilyLinkedList::Get(NameHandle full_name) {
+    STATS_COUNT(get_calls);
+    if (head_ == NULL) {
+        return NULL;
+    }
+    FamilyNode *node = head_;
+    while (node != NULL) {
+        STATS_COUNT(nodes_visited);
+        if (name_pool.Equals(node->person.full_name_handle(), full_name)) {
+            return node;
+        }
+        node = node->next;
+    }
+    // return NULL if full_name is not exist
+    return NULL;
+}
+
+/**
+ * Appends all of ancestors of the given `full_name` to `out`,
+ * `level` is used for indicates the level of ancestors.
+ */
+void FamilyLinkedList::AppendAncestors(NameHandle full_name, int level,
+        string *out) {
+    FamilyNode *person = Get(full_name);
+    // base case
+    if (person == NULL || full_name == kNotIdentifiedName) {
+        return;
+    }
+    FamilyNode *node = head_;
+
+    string prefix = "grand ";
+    int i;
+    // level - 1 because 1 level (grand father is not great-grand father)
+    for (i = 0; i < level - 1; i++) {
+        prefix = "great-" + prefix;
+    }
+    if (level == 0) {
+        prefix = "";
+    }
+
+    // printf("L %d\n", level);
+    // Only father and mother is look up based on the member variable not the
+    // node in linked list.
+    if (person->person.father_handle() != kNotIdentifiedName) {
+        AppendFormat(out, "%s, %sfather\n", person->father().c_str(),
+                prefix.c_str());
+        AppendAncestors(person->person.father_handle(), level + 1, out);
+    }
+    if (person->person.mother_handle() != kNotIdentifiedName) {
+        AppendFormat(out, "%s, %smother\n", person->mother().c_str(),
+                prefix.c_str());
+        AppendAncestors(person->person.mother_handle(), level + 1, out);
+    }
+}
+
+/**
+ * Appends all of descendants of the given `full_name` to `out`,
+ * `level` is used for indicates the level of descendants.
+ */
+void FamilyLinkedList::AppendDescendants(NameHandle full_name, int level,
+        string *out) {
+    FamilyNode *node = head_;
+    string prefix = "grand ";
+    int i;
+    // level -1 because 1 level is grand daughter or grand son
+    for (i = 0; i < level - 1; i++) {
+        prefix = "great-" + prefix;
+    }
+    if (level == 0) {
+        prefix = "";
+    }
+
+    while (node != NULL) {
+        STATS_COUNT(nodes_visited);
+        if (name_pool.Equals(node->person.father_handle(), full_name) ||
+            name_pool.Equals(node->person.mother_handle(), full_name)) {
+            if (node->person.is_female()) {
+                AppendFormat(out, "%s, %sdaughter\n",
+                        node->full_name().c_str(), prefix.c_str());
+            } else {
+                AppendFormat(out, "%s, %sson\n", node->full_name().c_str(),
+                        prefix.c_str());
+            }
+            // print descendants recursively
+            AppendDescendants(node->person.full_name_handle(), level + 1,
+                    out);
+        }
+        node = node->next;
+    }
+}
+
+/**
+ * Appends siblings of `full_name` to `out`.
+ */
+void FamilyLinkedList::AppendSiblings(NameHandle full_name, string *out) {
+    FamilyNode *person = Get(full_name);
+    FamilyNode *node = head_;
+
+    while (node != NULL) {
+        STATS_COUNT(nodes_visited);
+        // Common father or mother
+        if ((name_pool.Equals(node->person.father_handle(),
+                              person->person.father_handle()) ||
+             name_pool.Equals(node->person.mother_handle(),
+                              person->person.mother_handle())) &&
+             !name_pool.Equals(node->person.full_name_handle(),
+                               person->person.full_name_handle())) {
+            if (node->person.is_female()) {
+                if (node->age() == person->age()) {
+                    AppendFormat(out, "%s, sister [same age %d]\n",
+                            node->full_name().c_str(),
+                            person->age());
+                } else if (node->age() > person->age()) {
+                    AppendFormat(out, "%s, elder sister\n",
+                            node->full_name().c_str());
+                } else {
+                    AppendFormat(out, "%s, younger sister\n",
+                            node->full_name().c_str());
+                }
+            } else {
+                if (node->age() == person->age()) {
+                    AppendFormat(out, "%s, brother [same age %d]\n",
+                            node->full_name().c_str(),
+                            person->age());
+                } else if (node->age() > person->age()) {
+                    AppendFormat(out, "%s, elder brother\n",
+                            node->full_name().c_str());
+                } else {
+                    AppendFormat(out, "%s, younger brother\n",
+                            node->full_name().c_str());
+                }
+            }
+        }
+        node = node->next;
+    }
+}
+
+/**
+ * Adds person `p` to head of the linked list.
+ */
+void FamilyLinkedList::Add(Person p) {
+    FamilyNode *new_node = NewNode();
+    new_node->person = p;
+    new_node->next = head_;
+    head_ = new_node;
+    size_++;
+    InvalidateRelativesAround(new_node);
+}
+
+/**
+ * Adds all of `people` to head of the linked list in one pass, the same
+ * as Add for each of them. The whole relatives cache is dropped.
+ */
+void FamilyLinkedList::AddBatch(const std::vector<Person> &people) {
+    size_t i;
+    for (i = 0; i < people.size(); i++) {
+        FamilyNode *new_node = NewNode();
+        new_node->person = people[i];
+        new_node->next = head_;
+        head_ = new_node;
+    }
+    size_ += people.size();
+    relatives_cache_.Clear();
+}
+
+/**
+ * Deletes `full_name` from the linked list and returns
+ * the deleted person as a FamilyNode.
+ */
+FamilyNode *FamilyLinkedList::Delete(string full_name) {
+    FamilyNode *return_node = NULL;
+    NameHandle handle = name_pool.Find(full_name);
+    if (head_ == NULL || handle == kUnknownName) {
+        return return_node;
+    }
+    FamilyNode *current_node = head_->next;
+    FamilyNode *previous_node = head_;
+    FamilyNode *obsolete_node = NULL;
+    // head will be eliminated
+    if (previous_node != NULL &&
+            name_pool.Equals(previous_node->person.full_name_handle(),
+                             handle)) {
+        InvalidateRelativesAround(previous_node);
+        head_ = previous_node->next;
+        obsolete_node = previous_node;
+        return_node = previous_node;
+        FreeNode(obsolete_node);
+        size_--;
+        return return_node;
+    }
+
+    while (current_node != NULL) {
+        STATS_COUNT(nodes_visited);
+        if (name_pool.Equals(current_node->person.full_name_handle(),
+                             handle)) {
+            InvalidateRelativesAround(current_node);
+            obsolete_node = current_node;
+            return_node = current_node;
+            // last node will be eliminated
+            if (current_node->next == NULL) {
+                FamilyNode *temp_node = NULL;
+                // Searching for the node prior the tail
+                while (previous_node != current_node) {
+                    temp_node = previous_node;
+                    previous_node = previous_node->next;
+                }
+                temp_node->next = NULL;
+            } else {
+                // middle node will be eliminated
+                previous_node->next = current_node->next;
+            }
+            FreeNode(obsolete_node);
+            size_--;
+            return return_node;
+        }
+        current_node = current_node->next;
+        previous_node = previous_node->next;
+    }
+    return return_node;
+}
+
+/**
+ * Prints all nodes in the linked list.
+ */
+void FamilyLinkedList::PrintAllNodes() {
+    FamilyNode *node = head_;
+    if (size_ < 1) {
+        printf("[]\n");
+        return;
+    }
+    int i;
+    while (node != NULL) {
+        printf("%s\n", node->person.ToString().c_str());
+        node = node->next;
+    }
+    printf("Total: %d\n", size());
+}
+
+/**
+ * Prints all of the relative of `full_name`.
+ * The person full_name=`full_name` must exists in the linked list.
+ * The relatives are served from the cache until Add or Delete changes them.
+ */
+void FamilyLinkedList::PrintRelativesOf(string full_name) {
+    printf("\n%s's relatives:\n\n", full_name.c_str());
+    NameHandle key = name_pool.Find(full_name);
+    if (key == kUnknownName) {
+        return;
+    }
+    string relatives;
+    if (relatives_cache_.Lookup(key, &relatives)) {
+        STATS_COUNT(relatives_cache_hits);
+    } else {
+        STATS_COUNT(relatives_cache_misses);
+        AppendAncestors(key, 0, &relatives);
+        AppendDescendants(key, 0, &relatives);
+        AppendSiblings(key, &relatives);
+        relatives_cache_.Store(key, relatives);
+    }
+    printf("%s", relatives.c_str());
+    return;
+}
+
+/**
+ * Drops the cached relatives of everyone whose relatives change when
+ * `node` is added or deleted, i.e., the person, the ancestors found by
+ * the parent links, the descendants found by the child links and
+ * the siblings. `node` must still be in the linked list.
+ */
+void FamilyLinkedList::InvalidateRelativesAround(FamilyNode *node) {
+    if (relatives_cache_.empty()) {
+        return;
+    }
+    NameHandle full_name = node->person.full_name_handle();
+    relatives_cache_.Erase(name_pool.Folded(full_name));
+    std::unordered_set<NameHandle> visited;
+    InvalidateAncestors(node, &visited);
+    visited.clear();
+    InvalidateDescendants(full_name, &visited);
+
+    FamilyNode *sibling = head_;
+    while (sibling != NULL) {
+        STATS_COUNT(nodes_visited);
+        if (name_pool.Equals(sibling->person.father_handle(),
+                             node->person.father_handle()) ||
+            name_pool.Equals(sibling->person.mother_handle(),
+                             node->person.mother_handle())) {
+            relatives_cache_.Erase(
+                    name_pool.Folded(sibling->person.full_name_handle()));
+        }
+        sibling = sibling->next;
+    }
+}
+
+/**
+ * Drops the cached relatives of the ancestors of `node`, following the
+ * same parent links as AppendAncestors. `visited` guards against cycles.
+ */
+void FamilyLinkedList::InvalidateAncestors(FamilyNode *node,
+        std::unordered_set<NameHandle> *visited) {
+    NameHandle parents[2] = {
+        node->person.father_handle(), node->person.mother_handle()
+    };
+    int i;
+    for (i = 0; i < 2; i++) {
+        if (parents[i] == kNotIdentifiedName) {
+            continue;
+        }
+        NameHandle key = name_pool.Folded(parents[i]);
+        if (!visited->insert(key).second) {
+            continue;
+        }
+        relatives_cache_.Erase(key);
+        FamilyNode *parent = Get(parents[i]);
+        if (parent != NULL) {
+            InvalidateAncestors(parent, visited);
+        }
+    }
+}
+
+/**
+ * Drops the cached relatives of the descendants of `full_name`, following
+ * the same child links as AppendDescendants. `visited` guards against
+ * cycles.
+ */
+void FamilyLinkedList::InvalidateDescendants(NameHandle full_name,
+        std::unordered_set<NameHandle> *visited) {
+    FamilyNode *node = head_;
+    while (node != NULL) {
+        STATS_COUNT(nodes_visited);
+        if (name_pool.Equals(node->person.father_handle(), full_name) ||
+            name_pool.Equals(node->person.mother_handle(), full_name)) {
+            NameHandle key = name_pool.Folded(node->person.full_name_handle());
+            if (visited->insert(key).second) {
+                relatives_cache_.Erase(key);
+                InvalidateDescendants(key, visited);
+            }
+        }
+        node = node->next;
+    }
+}
+
+/**
+ * Returns the current size of the linked list.
+ */
+int FamilyLinkedList::size() {
+    return size_;
+}
+
+// Size of the buffer of BufferedWriter.
+const size_t kWriteBufferSize = 1 << 16;
+
+/**
+ * Class prototype for the buffered writer of the exports.
+ * The output goes to the file kWriteBufferSize bytes at a time,
+ * so a document is never built in memory.
+ */
+class BufferedWriter {
+    public:
+        explicit BufferedWriter(FILE *file);
+        ~BufferedWriter();
+        void Write(const char *str, size_t length);
+        void Write(const char *str);
+        void WriteNumber(unsigned int number);
+        bool Flush();
+    private:
+        FILE *file_;
+        std::vector<char> buffer_;
+        size_t used_;
+        bool failed_;
+};
+
+/**
+ * Constructs writer to the given opened `file`.
+ */
+BufferedWriter::BufferedWriter(FILE *file) {
+    file_ = file;
+    buffer_.resize(kWriteBufferSize);
+    used_ = 0;
+    failed_ = false;
+}
+
+/**
+ * Flushes the rest of the buffer, the file is left open.
+ */
+BufferedWriter::~BufferedWriter() {
+    Flush();
+}
+
+/**
+ * Writes `length` bytes of `str`.
+ */
+void BufferedWriter::Write(const char *str, size_t length) {
+    if (used_ + length > buffer_.size()) {
+        Flush();
+        if (length > buffer_.size()) {
+            if (fwrite(str, 1, length, file_) != length) {
+                failed_ = true;
+            }
+            return;
+        }
+    }
+    memcpy(&buffer_[used_], str, length);
+    used_ += length;
+}
+
+/**
+ * Writes the NUL terminated `str`.
+ */
+void BufferedWriter::Write(const char *str) {
+    Write(str, strlen(str));
+}
+
+/**
+ * Writes `number` in decimal.
+ */
+void BufferedWriter::WriteNumber(unsigned int number) {
+    char digits[16];
+    int i = sizeof(digits);
+    do {
+        digits[--i] = '0' + number % 10;
+        number /= 10;
+    } while (number > 0);
+    Write(digits + i, sizeof(digits) - i);
+}
+
+/**
+ * Writes the buffer to the file.
+ * Returns false if any write has failed.
+ */
+bool BufferedWriter::Flush() {
+    if (used_ > 0) {
+        if (fwrite(&buffer_[0], 1, used_, file_) != used_) {
+            failed_ = true;
+        }
+        used_ = 0;
+    }
+    return !failed_;
+}
+
+/**
+ * People of an export, numbered from 1 in the order of the walk.
+ * Parents who are not exported themselves are numbered after them
+ * and exported by name only.
+ */
+struct ExportIndex {
+    std::vector<FamilyNode *> people;
+    std::vector<NameHandle> parent_names;
+    std::vector<uint8_t> parent_genders;
+    // Number of each exported name by its folded handle, 0 if none.
+    std::vector<uint32_t> ids;
+    // Only the descendants of people[0] are exported, so the parents
+    // of people[0] are left out.
+    bool subtree;
+};
+
+/**
+ * Walks `family_linked_list` and numbers the people to export into
+ * `index`, the whole tree if `root_name` is empty, otherwise `root_name`
+ * and the descendants found by the child links.
+ * Returns false if `root_name` does not exist.
+ */
+bool CollectExport(FamilyLinkedList *family_linked_list, string root_name,
+        ExportIndex *index) {
+    index->ids.assign(name_pool.size(), 0);
+    index->subtree = root_name.compare("") != 0;
+    FamilyNode *node;
+    if (!index->subtree) {
+        for (node = family_linked_list->head_; node != NULL;
+                node = node->next) {
+            uint32_t &id = index->ids[
+                name_pool.Folded(node->person.full_name_handle())];
+            if (id == 0) {
+                index->people.push_back(node);
+                id = index->people.size();
+            }
+        }
+        return true;
+    }
+
+    node = family_linked_list->Get(root_name);
+    if (node == NULL) {
+        return false;
+    }
+    // Child links sorted by the folded name of the parent.
+    std::vector<std::pair<NameHandle, FamilyNode *> > children;
+    FamilyNode *child;
+    for (child = family_linked_list->head_; child != NULL;
+            child = child->next) {
+        if (child->person.father_handle() != kNotIdentifiedName) {
+            children.push_back(std::make_pair(
+                        name_pool.Folded(child->person.father_handle()),
+                        child));
+        }
+        if (child->person.mother_handle() != kNotIdentifiedName) {
+            children.push_back(std::make_pair(
+                        name_pool.Folded(child->person.mother_handle()),
+                        child));
+        }
+    }
+    std::sort(children.begin(), children.end());
+
+    index->people.push_back(node);
+    index->ids[name_pool.Folded(node->person.full_name_handle())] = 1;
+    size_t i;
+    for (i = 0; i < index->people.size(); i++) {
+        NameHandle parent =
+            name_pool.Folded(index->people[i]->person.full_name_handle());
+        std::vector<std::pair<NameHandle, FamilyNode *> >::iterator it =
+            std::lower_bound(children.begin(), children.end(),
+                    std::make_pair(parent, static_cast<FamilyNode *>(NULL)));
+        for (; it != children.end() && it->first == parent; ++it) {
+            uint32_t &id = index->ids[
+                name_pool.Folded(it->second->person.full_name_handle())];
+            if (id == 0) {
+                index->people.push_back(it->second);
+                id = index->people.size();
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the number of `parent` in `index`, numbers it as a name only
+ * person of `gender` if needed. Returns 0 for "not identified".
+ */
+uint32_t ExportParentId(ExportIndex *index, NameHandle parent,
+        uint8_t gender) {
+    if (parent == kNotIdentifiedName) {
+        return 0;
+    }
+    uint32_t &id = index->ids[name_pool.Folded(parent)];
+    if (id == 0) {
+        index->parent_names.push_back(parent);
+        index->parent_genders.push_back(gender);
+        id = index->people.size() + index->parent_names.size();
+    }
+    return id;
+}
+
+/**
+ * Returns the current year of the local time.
+ */
+int CurrentYear() {
+    time_t now = time(NULL);
+    struct tm *local = localtime(&now);
+    return local->tm_year + 1900;
+}
+
+/**
+ * Writes a GEDCOM cross reference such as @I12@.
+ */
+void WriteGedcomXref(BufferedWriter *writer, char kind, uint32_t id) {
+    char prefix[3] = {'@', kind, '\0'};
+    writer->Write(prefix, 2);
+    writer->WriteNumber(id);
+    writer->Write("@", 1);
+}
+
+/**
+ * Writes `str` as a GEDCOM line value, i.e., with every "@" doubled.
+ * Slashes become spaces if `is_slash_space`.
+ */
+void WriteGedcomValue(BufferedWriter *writer, const char *str,
+        bool is_slash_space) {
+    const char *special = is_slash_space ? "@/" : "@";
+    for (;;) {
+        size_t length = strcspn(str, special);
+        writer->Write(str, length);
+        str += length;
+        if (*str == '\0') {
+            return;
+        }
+        writer->Write(*str == '@' ? "@@" : " ", *str == '@' ? 2 : 1);
+        str++;
+    }
+}
+
+/**
+ * Writes the NAME of `name` with the surname between slashes. A name
+ * with slashes of its own cannot be delimited, so it is written without
+ * them and its exact parts follow as GIVN and SURN.
+ */
+void WriteGedcomName(BufferedWriter *writer, NameHandle name) {
+    const char *given_name = name_pool.GivenName(name);
+    const char *surname = name_pool.Surname(name);
+    writer->Write("1 NAME ");
+    if (strchr(given_name, '/') != NULL || strchr(surname, '/') != NULL) {
+        WriteGedcomValue(writer, given_name, true);
+        if (surname[0] != '\0') {
+            writer->Write(" ", 1);
+            WriteGedcomValue(writer, surname, true);
+        }
+        writer->Write("\n2 GIVN ");
+        WriteGedcomValue(writer, given_name, false);
+        if (surname[0] != '\0') {
+            writer->Write("\n2 SURN ");
+            WriteGedcomValue(writer, surname, false);
+        }
+    } else {
+        WriteGedcomValue(writer, given_name, false);
+        if (surname[0] != '\0') {
+            writer->Write(" /", 2);
+            WriteGedcomValue(writer, surname, false);
+            writer->Write("/", 1);
+        }
+    }
+}
+
+/**
+ * Writes the INDI record of person `id`.
+ * `families` are the ids of the families the person is a parent of.
+ * A parent who is only named and not in the tree is marked `is_name_only`
+ * with a _NAMEONLY line, so importing the file does not add them.
+ */
+void WriteGedcomIndividual(BufferedWriter *writer, uint32_t id,
+        NameHandle name, uint8_t gender, int birth_year, uint32_t family,
+        const uint32_t *families, size_t family_count, bool is_name_only) {
+    writer->Write("0 ", 2);
+    WriteGedcomXref(writer, 'I', id);
+    writer->Write(" INDI\n");
+    WriteGedcomName(writer, name);
+    if (gender == kGenderMale) {
+        writer->Write("\n1 SEX M\n");
+    } else if (gender == kGenderFemale) {
+        writer->Write("\n1 SEX F\n");
+    } else {
+        writer->Write("\n1 SEX U\n");
+    }
+    if (is_name_only) {
+        writer->Write("1 _NAMEONLY Y\n");
+    }
+    if (birth_year >= 0) {
+        writer->Write("1 BIRT\n2 DATE ABT ");
+        writer->WriteNumber(birth_year);
+        writer->Write("\n", 1);
+    }
+    if (family != 0) {
+        writer->Write("1 FAMC ");
+        WriteGedcomXref(writer, 'F', family);
+        writer->Write("\n", 1);
+    }
+    size_t i;
+    for (i = 0; i < family_count; i++) {
+        writer->Write("1 FAMS ");
+        WriteGedcomXref(writer, 'F', families[i]);
+        writer->Write("\n", 1);
+    }
+}
+
+/**
+ * Writes the people of `index` as a GEDCOM 5.5.1 lineage-linked file.
+ * There is one FAM record for each distinct father and mother, the age
+ * becomes an approximate birth year.
+ */
+void ExportGedcom(ExportIndex *index, BufferedWriter *writer) {
+    size_t people = index->people.size();
+    std::unordered_map<uint64_t, uint32_t> family_ids;
+    std::vector<uint32_t> husbands;
+    std::vector<uint32_t> wives;
+    // Family of the parents of each person.
+    std::vector<uint32_t> child_families(people, 0);
+    size_t i;
+    for (i = index->subtree ? 1 : 0; i < people; i++) {
+        Person &person = index->people[i]->person;
+        uint32_t father = ExportParentId(index, person.father_handle(),
+                kGenderMale);
+        uint32_t mother = ExportParentId(index, person.mother_handle(),
+                kGenderFemale);
+        if (father == 0 && mother == 0) {
+            continue;
+        }
+        uint64_t key = static_cast<uint64_t>(father) << 32 | mother;
+        std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool>
+            family = family_ids.insert(
+                    std::make_pair(key, husbands.size() + 1));
+        if (family.second) {
+            husbands.push_back(father);
+            wives.push_back(mother);
+        }
+        child_families[i] = family.first->second;
+    }
+    family_ids.clear();
+
+    // Children of each family and families of each parent, both as
+    // offsets into one array.
+    size_t families = husbands.size();
+    size_t total = people + index->parent_names.size();
+    std::vector<uint32_t> child_offsets(families + 2, 0);
+    std::vector<uint32_t> spouse_offsets(total + 2, 0);
+    for (i = 0; i < people; i++) {
+        if (child_families[i] != 0) {
+            child_offsets[child_families[i] + 1]++;
+        }
+    }
+    for (i = 0; i < families; i++) {
+        if (husbands[i] != 0) {
+            spouse_offsets[husbands[i] + 1]++;
+        }
+        if (wives[i] != 0) {
+            spouse_offsets[wives[i] + 1]++;
+        }
+    }
+    for (i = 1; i < child_offsets.size(); i++) {
+        child_offsets[i] += child_offsets[i - 1];
+    }
+    for (i = 1; i < spouse_offsets.size(); i++) {
+        spouse_offsets[i] += spouse_offsets[i - 1];
+    }
+    std::vector<uint32_t> children(child_offsets.back());
+    std::vector<uint32_t> spouse_families(spouse_offsets.back());
+    std::vector<uint32_t> cursor(child_offsets.begin(),
+            child_offsets.end() - 1);
+    for (i = 0; i < people; i++) {
+        if (child_families[i] != 0) {
+            children[cursor[child_families[i]]++] = i + 1;
+        }
+    }
+    cursor.assign(spouse_offsets.begin(), spouse_offsets.end() - 1);
+    for (i = 0; i < families; i++) {
+        if (husbands[i] != 0) {
+            spouse_families[cursor[husbands[i]]++] = i + 1;
+        }
+        if (wives[i] != 0) {
+            spouse_families[cursor[wives[i]]++] = i + 1;
+        }
+    }
+    cursor.clear();
+
+    // GEDCOM 5.5.1 requires a submitter, which is this program.
+    writer->Write("0 HEAD\n1 SOUR FAMILY_TREE\n1 SUBM @U1@\n1 GEDC\n"
+            "2 VERS 5.5.1\n2 FORM LINEAGE-LINKED\n1 CHAR UTF-8\n"
+            "0 @U1@ SUBM\n1 NAME Family Tree\n");
+    int year = CurrentYear();
+    for (i = 0; i < total; i++) {
+        uint32_t id = i + 1;
+        const uint32_t *families_of = spouse_families.empty() ? NULL :
+            &spouse_families[0] + spouse_offsets[id];
+        size_t family_count = spouse_offsets[id + 1] - spouse_offsets[id];
+        if (i < people) {
+            Person &person = index->people[i]->person;
+            WriteGedcomIndividual(writer, id, person.full_name_handle(),
+                    person.gender_code(), year - person.age(),
+                    child_families[i],
+                    families_of, family_count, false);
+        } else {
+            WriteGedcomIndividual(writer, id,
+                    index->parent_names[i - people],
+                    index->parent_genders[i - people], -1, 0,
+                    families_of, family_count, true);
+        }
+    }
+    for (i = 0; i < families; i++) {
+        uint32_t id = i + 1;
+        writer->Write("0 ", 2);
+        WriteGedcomXref(writer, 'F', id);
+        writer->Write(" FAM\n");
+        if (husbands[i] != 0) {
+            writer->Write("1 HUSB ");
+            WriteGedcomXref(writer, 'I', husbands[i]);
+            writer->Write("\n", 1);
+        }
+        if (wives[i] != 0) {
+            writer->Write("1 WIFE ");
+            WriteGedcomXref(writer, 'I', wives[i]);
+            writer->Write("\n", 1);
+        }
+        uint32_t j;
+        for (j = child_offsets[id]; j < child_offsets[id + 1]; j++) {
+            writer->Write("1 CHIL ");
+            WriteGedcomXref(writer, 'I', children[j]);
+            writer->Write("\n", 1);
+        }
+    }
+    writer->Write("0 TRLR\n");
+}
+
+/**
+ * Writes `str` as the inside of a DOT quoted string.
+ */
+void WriteDotEscaped(BufferedWriter *writer, const string &str) {
+    size_t begin = 0;
+    size_t i;
+    for (i = 0; i < str.size(); i++) {
+        if (str[i] == '"' || str[i] == '\\') {
+            writer->Write(str.data() + begin, i - begin);
+            writer->Write("\\", 1);
+            begin = i;
+        }
+    }
+    writer->Write(str.data() + begin, str.size() - begin);
+}
+
+/**
+ * Writes the parent to child edge from `parent` to `child`.
+ */
+void WriteDotEdge(BufferedWriter *writer, uint32_t parent, uint32_t child) {
+    writer->Write("    p", 5);
+    writer->WriteNumber(parent);
+    writer->Write(" -> p", 5);
+    writer->WriteNumber(child);
+    writer->Write(";\n", 2);
+}
+
+/**
+ * Writes the people of `index` as a Graphviz DOT digraph with an edge
+ * from each parent to each child. Name only parents are dashed.
+ */
+void ExportDot(ExportIndex *index, BufferedWriter *writer) {
+    writer->Write("digraph family_tree {\n    node [shape=box];\n");
+    size_t people = index->people.size();
+    size_t parents_written = 0;
+    size_t i;
+    for (i = 0; i < people; i++) {
+        Person &person = index->people[i]->person;
+        writer->Write("    p", 5);
+        writer->WriteNumber(i + 1);
+        writer->Write(" [label=\"");
+        WriteDotEscaped(writer, person.full_name());
+        writer->Write("\\n", 2);
+        writer->WriteNumber(person.age());
+        writer->Write(", ", 2);
+        writer->Write(person.gender().c_str());
+        writer->Write("\"];\n");
+        if (index->subtree && i == 0) {
+            continue;
+        }
+        uint32_t father = ExportParentId(index, person.father_handle(),
+                kGenderMale);
+        uint32_t mother = ExportParentId(index, person.mother_handle(),
+                kGenderFemale);
+        for (; parents_written < index->parent_names.size();
+                parents_written++) {
+            writer->Write("    p", 5);
+            writer->WriteNumber(people + parents_written + 1);
+            writer->Write(" [label=\"");
+            WriteDotEscaped(writer,
+                    name_pool.Get(index->parent_names[parents_written]));
+            writer->Write("\", style=dashed];\n");
+        }
+        if (father != 0) {
+            WriteDotEdge(writer, father, i + 1);
+        }
+        if (mother != 0) {
+            WriteDotEdge(writer, mother, i + 1);
+        }
+    }
+    writer->Write("}\n", 2);
+}
+
+// Bytes of a GEDCOM file read at a time.
+const size_t kImportBlockSize = 16 << 20;
+// Blocks are not split into chunks smaller than this.
+const size_t kMinImportChunkSize = 1 << 16;
+
+/**
+ * Text inside the block of a GEDCOM file being imported.
+ */
+struct GedcomText {
+    const char *data;
+    size_t size;
+};
+
+// Cross reference index of a GedcomRecord which has none.
+const uint32_t kNoXref = 0xFFFFFFFF;
+
+/**
+ * Cross reference such as @I12@ in a GEDCOM file, hashed by the thread
+ * which parses it.
+ */
+struct GedcomXref {
+    GedcomText text;
+    uint32_t hash;
+    bool is_family;
+};
+
+/**
+ * Individual (INDI) or family (FAM) record of a GEDCOM file.
+ * The cross references are indexes in GedcomChunk::xrefs.
+ */
+struct GedcomRecord {
+    bool is_family;
+    uint32_t xref;
+    // NAME without the slashes, at name_offset of GedcomChunk::names,
+    // and its NamePool::FoldedHash.
+    size_t name_offset;
+    size_t name_size;
+    uint32_t name_hash;
+    bool has_name;
+    // GIVN and SURN of the NAME, data is NULL if not given. The surname
+    // is the one between the slashes of the NAME until a SURN is given.
+    GedcomText given_name;
+    GedcomText surname;
+    uint8_t gender;
+    // Year of BIRT, -1 if unknown.
+    int birth_year;
+    // _NAMEONLY of the parents who are only named by the exporter.
+    bool is_name_only;
+    // FAMC of an individual.
+    uint32_t family;
+    // HUSB and WIFE of a family.
+    uint32_t husband;
+    uint32_t wife;
+    // FAMS of an individual or CHIL of a family, in GedcomChunk::links.
+    size_t links_begin;
+    size_t links_end;
+};
+
+/**
+ * Part of a block which starts at a record, parsed by one thread.
+ */
+struct GedcomChunk {
+    const char *begin;
+    const char *end;
+    std::vector<GedcomRecord> records;
+    std::vector<GedcomXref> xrefs;
+    // Number of each of xrefs, see GedcomImporter::Merge.
+    std::vector<uint32_t> xref_ids;
+    std::vector<uint32_t> links;
+    string names;
+};
+
+/**
+ * Returns true if `text` is `str`.
+ */
+bool GedcomTextIs(GedcomText text, const char *str) {
+    return strlen(str) == text.size &&
+        memcmp(text.data, str, text.size) == 0;
+}
+
+/**
+ * Returns true if a record starts at `position`, i.e., a line of level 0.
+ */
+bool IsGedcomRecordStart(const char *begin, const char *position,
+        const char *end) {
+    return (position == begin || position[-1] == '\n') &&
+        position + 1 < end && position[0] == '0' && position[1] == ' ';
+}
+
+/**
+ * Returns the start of the first record in [`from`, `end`), or `end`.
+ */
+const char *NextGedcomRecordStart(const char *begin, const char *from,
+        const char *end) {
+    const char *position = from;
+    while (position < end) {
+        if (IsGedcomRecordStart(begin, position, end)) {
+            return position;
+        }
+        const char *line_end = static_cast<const char *>(
+                memchr(position, '\n', end - position));
+        if (line_end == NULL) {
+            return end;
+        }
+        position = line_end + 1;
+    }
+    return end;
+}
+
+/**
+ * Returns the start of the last record in (`begin`, `end`), or `begin`.
+ */
+const char *LastGedcomRecordStart(const char *begin, const char *end) {
+    const char *position = end - 1;
+    while (position > begin) {
+        if (position[-1] == '\n' &&
+                IsGedcomRecordStart(begin, position, end)) {
+            return position;
+        }
+        position--;
+    }
+    return begin;
+}
+
+/**
+ * Returns the year of a GEDCOM DATE, the last number of 3 or 4 digits,
+ * or -1 if none.
+ */
+int GedcomYear(GedcomText date) {
+    int year = -1;
+    size_t i = 0;
+    while (i < date.size) {
+        if (!isdigit(static_cast<unsigned char>(date.data[i]))) {
+            i++;
+            continue;
+        }
+        int number = 0;
+        size_t digits = 0;
+        for (; i < date.size &&
+                isdigit(static_cast<unsigned char>(date.data[i])); i++) {
+            number = number * 10 + (date.data[i] - '0');
+            digits++;
+        }
+        if (digits == 3 || digits == 4) {
+            year = number;
+        }
+    }
+    return year;
+}
+
+/**
+ * Appends the GEDCOM NAME `value` to `names` with "@@" as "@" and the
+ * slashes around the surname as spaces, then trimmed like SuperTrim.
+ * The slashes of a GIVN or SURN `value` are kept if `is_piece`.
+ */
+void AppendGedcomName(GedcomText value, bool is_piece, string *names) {
+    bool pending_space = false;
+    size_t start = names->size();
+    size_t i;
+    for (i = 0; i < value.size; i++) {
+        char c = value.data[i];
+        if ((c == '/' && !is_piece) || c == ' ' || c == '\t') {
+            pending_space = true;
+            continue;
+        }
+        if (pending_space && names->size() > start) {
+            *names += ' ';
+        }
+        pending_space = false;
+        *names += c;
+        if (c == '@' && i + 1 < value.size && value.data[i + 1] == '@') {
+            i++;
+        }
+    }
+}
+
+/**
+ * Returns the surname between the slashes of the GEDCOM NAME `value`,
+ * data is NULL if it has no slash.
+ */
+GedcomText GedcomNameSurname(GedcomText value) {
+    GedcomText surname = {NULL, 0};
+    const char *end = value.data + value.size;
+    const char *slash = static_cast<const char *>(
+            memchr(value.data, '/', value.size));
+    if (slash == NULL) {
+        return surname;
+    }
+    surname.data = slash + 1;
+    slash = static_cast<const char *>(memchr(surname.data, '/',
+                end - surname.data));
+    surname.size = (slash == NULL ? end : slash) - surname.data;
+    return surname;
+}
+
+/**
+ * Replaces the name of `record`, the last one in `names`, by its
+ * GIVN and surname once the GIVN is known.
+ */
+void ReplaceGedcomNameByPieces(GedcomRecord *record, string *names) {
+    if (record->given_name.data == NULL) {
+        return;
+    }
+    names->resize(record->name_offset);
+    AppendGedcomName(record->given_name, true, names);
+    size_t surname_offset = names->size();
+    if (record->surname.data != NULL) {
+        AppendGedcomName(record->surname, true, names);
+    }
+    if (surname_offset > record->name_offset &&
+            names->size() > surname_offset) {
+        names->insert(surname_offset, 1, ' ');
+    }
+    record->name_size = names->size() - record->name_offset;
+}
+
+/**
+ * Adds the cross reference `text` to `chunk` and returns its index,
+ * or kNoXref if `text` is empty.
+ */
+uint32_t AddGedcomXref(GedcomChunk *chunk, GedcomText text, bool is_family) {
+    if (text.size == 0) {
+        return kNoXref;
+    }
+    GedcomXref xref;
+    xref.text = text;
+    xref.hash = kHashOffsetBasis;
+    size_t i;
+    for (i = 0; i < text.size; i++) {
+        xref.hash ^= static_cast<unsigned char>(text.data[i]);
+        xref.hash *= kHashPrime;
+    }
+    xref.is_family = is_family;
+    chunk->xrefs.push_back(xref);
+    return chunk->xrefs.size() - 1;
+}
+
+/**
+ * Parses the INDI and FAM records of `chunk`, the other records
+ * are skipped. The cross references and the names are hashed here too,
+ * so the importer can look them up on all of the cores.
+ */
+void ParseGedcomChunk(GedcomChunk *chunk) {
+    GedcomRecord *record = NULL;
+    bool in_birth = false;
+    bool in_name = false;
+    const char *line = chunk->begin;
+    while (line < chunk->end) {
+        const char *line_end = static_cast<const char *>(
+                memchr(line, '\n', chunk->end - line));
+        if (line_end == NULL) {
+            line_end = chunk->end;
+        }
+        const char *next_line = line_end + (line_end < chunk->end ? 1 : 0);
+        const char *stop = line_end;
+        while (stop > line && (stop[-1] == '\r' || stop[-1] == ' ')) {
+            stop--;
+        }
+        const char *p = line;
+        while (p < stop && *p == ' ') {
+            p++;
+        }
+        if (p == stop || !isdigit(static_cast<unsigned char>(*p))) {
+            line = next_line;
+            continue;
+        }
+        int level = 0;
+        for (; p < stop && isdigit(static_cast<unsigned char>(*p)); p++) {
+            level = level * 10 + (*p - '0');
+        }
+        while (p < stop && *p == ' ') {
+            p++;
+        }
+        GedcomText xref = {p, 0};
+        if (p < stop && *p == '@') {
+            const char *xref_end = static_cast<const char *>(
+                    memchr(p + 1, '@', stop - p - 1));
+            if (xref_end != NULL) {
+                xref.size = xref_end + 1 - p;
+                p = xref_end + 1;
+                while (p < stop && *p == ' ') {
+                    p++;
+                }
+            }
+        }
+        GedcomText tag = {p, 0};
+        while (p < stop && *p != ' ') {
+            p++;
+        }
+        tag.size = p - tag.data;
+        if (p < stop) {
+            p++;
+        }
+        GedcomText value = {p, static_cast<size_t>(stop - p)};
+        line = next_line;
+
+        if (level == 0) {
+            record = NULL;
+            in_birth = false;
+            in_name = false;
+            bool is_family = GedcomTextIs(tag, "FAM");
+            if (xref.size == 0 || (!is_family && !GedcomTextIs(tag, "INDI"))) {
+                continue;
+            }
+            GedcomRecord new_record;
+            GedcomText none = {NULL, 0};
+            new_record.is_family = is_family;
+            new_record.xref = AddGedcomXref(chunk, xref, is_family);
+            new_record.name_offset = 0;
+            new_record.name_size = 0;
+            new_record.name_hash = 0;
+            new_record.has_name = false;
+            new_record.given_name = none;
+            new_record.surname = none;
+            new_record.gender = kGenderNotIdentified;
+            new_record.birth_year = -1;
+            new_record.is_name_only = false;
+            new_record.family = kNoXref;
+            new_record.husband = kNoXref;
+            new_record.wife = kNoXref;
+            new_record.links_begin = chunk->links.size();
+            new_record.links_end = chunk->links.size();
+            chunk->records.push_back(new_record);
+            record = &chunk->records.back();
+        } else if (record == NULL) {
+            continue;
+        } else if (level == 1) {
+            in_birth = GedcomTextIs(tag, "BIRT");
+            in_name = false;
+            if (record->is_family) {
+                if (GedcomTextIs(tag, "HUSB")) {
+                    record->husband = AddGedcomXref(chunk, value, false);
+                } else if (GedcomTextIs(tag, "WIFE")) {
+                    record->wife = AddGedcomXref(chunk, value, false);
+                } else if (GedcomTextIs(tag, "CHIL") && value.size > 0) {
+                    chunk->links.push_back(
+                            AddGedcomXref(chunk, value, false));
+                    record->links_end = chunk->links.size();
+                }
+            } else if (GedcomTextIs(tag, "NAME")) {
+                if (!record->has_name) {
+                    record->has_name = true;
+                    in_name = true;
+                    record->name_offset = chunk->names.size();
+                    AppendGedcomName(value, false, &chunk->names);
+                    record->name_size =
+                        chunk->names.size() - record->name_offset;
+                    record->surname = GedcomNameSurname(value);
+                }
+            } else if (GedcomTextIs(tag, "SEX") && value.size > 0) {
+                if (value.data[0] == 'M') {
+                    record->gender = kGenderMale;
+                } else if (value.data[0] == 'F') {
+                    record->gender = kGenderFemale;
+                }
+            } else if (GedcomTextIs(tag, "_NAMEONLY")) {
+                record->is_name_only = value.size > 0 && value.data[0] == 'Y';
+            } else if (GedcomTextIs(tag, "FAMC")) {
+                if (record->family == kNoXref) {
+                    record->family = AddGedcomXref(chunk, value, true);
+                }
+            } else if (GedcomTextIs(tag, "FAMS") && value.size > 0) {
+                chunk->links.push_back(AddGedcomXref(chunk, value, true));
+                record->links_end = chunk->links.size();
+            }
+        } else if (level == 2 && in_birth && GedcomTextIs(tag, "DATE")) {
+            record->birth_year = GedcomYear(value);
+        } else if (level == 2 && in_name && GedcomTextIs(tag, "GIVN")) {
+            record->given_name = value;
+            ReplaceGedcomNameByPieces(record, &chunk->names);
+        } else if (level == 2 && in_name && GedcomTextIs(tag, "SURN")) {
+            record->surname = value;
+            ReplaceGedcomNameByPieces(record, &chunk->names);
+        }
+    }
+    size_t i;
+    for (i = 0; i < chunk->records.size(); i++) {
+        GedcomRecord &named = chunk->records[i];
+        if (named.has_name && named.name_size > 0) {
+            named.name_hash = NamePool::FoldedHash(
+                    &chunk->names[named.name_offset], named.name_size);
+        }
+    }
+}
+
+/**
+ * Class prototype for the numbering of GEDCOM cross references.
+ * The cross references are kept in one array, each slot of the open
+ * addressing table holds the hash and the number + 1 of one of them.
+ */
+class GedcomXrefs {
+    public:
+        GedcomXrefs();
+        uint32_t Number(GedcomText xref, uint32_t hash);
+    private:
+        std::vector<char> bytes_;
+        std::vector<size_t> offsets_;
+        std::vector<uint64_t> slots_;
+};
+
+// Slots of a new GedcomXrefs, small since there is one for each shard.
+const size_t kInitialXrefSlots = 64;
+
+/**
+ * Constructs empty numbering.
+ */
+GedcomXrefs::GedcomXrefs() {
+    offsets_.push_back(0);
+    slots_.assign(kInitialXrefSlots, 0);
+}
+
+/**
+ * Returns the number of `xref` whose hash is `hash`, the next number if
+ * it is new.
+ */
+uint32_t GedcomXrefs::Number(GedcomText xref, uint32_t hash) {
+    size_t slot = SlotOf(hash, slots_.size());
+    while (slots_[slot] != 0) {
+        uint32_t number = static_cast<uint32_t>(slots_[slot]) - 1;
+        size_t length = offsets_[number + 1] - offsets_[number];
+        if (slots_[slot] >> 32 == hash && length == xref.size &&
+                memcmp(&bytes_[offsets_[number]], xref.data, length) == 0) {
+            return number;
+        }
+        slot = NextSlot(slot, slots_.size());
     }
-
-    string sex() {
-        return person.gender();
+    uint32_t number = offsets_.size() - 1;
+    bytes_.insert(bytes_.end(), xref.data, xref.data + xref.size);
+    offsets_.push_back(bytes_.size());
+    slots_[slot] = static_cast<uint64_t>(hash) << 32 | (number + 1);
+    if (offsets_.size() * 2 > slots_.size()) {
+        std::vector<uint64_t> slots(slots_.size() * 2, 0);
+        size_t i;
+        for (i = 0; i < slots_.size(); i++) {
+            if (slots_[i] != 0) {
+                slot = SlotOf(slots_[i] >> 32, slots.size());
+                while (slots[slot] != 0) {
+                    slot = NextSlot(slot, slots.size());
+                }
+                slots[slot] = slots_[i];
+            }
+        }
+        slots_.swap(slots);
     }
-};
+    return number;
+}
+
+// Cross references are numbered in this many GedcomXrefs, split by the
+// hash, so that each thread numbers the shards it owns.
+const uint32_t kXrefShards = 64;
+// Set in the results of the names which are not in the pool yet.
+const uint32_t kPendingName = 0x80000000u;
+// PendingName::folded_pending of the names which fold into no pending one.
+const uint32_t kNoPendingName = 0xFFFFFFFF;
 
 /**
- * Class prototype for linked list of the family tree.
+ * Class prototype for the GEDCOM importer.
+ * Blocks of the file are split into chunks at record boundaries and
+ * parsed in parallel. Then every thread numbers the cross references
+ * and looks up the names of the hash shards it owns, and the main
+ * thread merges the results in the file order. Cross references are
+ * resolved once the whole file is read.
  */
-class FamilyLinkedList {
+class GedcomImporter {
     public:
-        FamilyLinkedList();
-        ~FamilyLinkedList();
-        FamilyNode *Get(string full_name);
-        void PrintAncestors(string full_name, int level);
-        void PrintDescendants(string full_name, int level);
-        void PrintSiblings(string full_name);
-        void Add(Person p);
-        FamilyNode *Delete(string full_name);
-        void PrintAllNodes();
-        void PrintRelativesOf(string full_name);
-        int size();
-        FamilyNode *head_;
+        explicit GedcomImporter(size_t threads);
+        bool Read(FILE *file);
+        void Resolve(std::vector<Person> *people);
+        size_t bytes();
+        size_t records();
+        size_t threads();
+        double parallel_seconds();
     private:
-        int size_;
+        struct Individual {
+            NameHandle name;
+            uint32_t family;
+            uint16_t age;
+            uint8_t gender;
+            // Only names a parent, see WriteGedcomIndividual.
+            bool is_name_only;
+        };
+        struct Family {
+            uint32_t husband;
+            uint32_t wife;
+        };
+        // Name of a block which is not in the pool, found by one thread.
+        struct PendingName {
+            const char *name;
+            size_t length;
+            uint32_t hash;
+            // Folded handle of a pooled name which equals ignoring case,
+            // or the earlier pending name which does.
+            NameHandle folded;
+            uint32_t folded_pending;
+            // Set once it is added to the pool.
+            NameHandle handle;
+            NameHandle root;
+        };
+        // What one thread found for the shards it owns, in the file order.
+        struct ThreadWork {
+            std::vector<uint32_t> xref_ids;
+            // Handles, or indexes of pending or'ed with kPendingName.
+            std::vector<uint32_t> names;
+            std::vector<PendingName> pending;
+            // Open addressing table of pending, index + 1 in each slot.
+            std::vector<uint32_t> pending_slots;
+            size_t xref_cursor;
+            size_t name_cursor;
+        };
+        void ParseBlock(const char *begin, const char *end);
+        void Number(const std::vector<GedcomChunk> &chunks, size_t thread,
+                size_t threads, ThreadWork *work);
+        uint32_t LookupName(const char *name, size_t length, uint32_t hash,
+                ThreadWork *work);
+        NameHandle AddName(PendingName *name, ThreadWork *work);
+        void Merge(GedcomChunk *chunk, size_t threads,
+                std::vector<ThreadWork> *works);
+        Individual &IndividualOf(uint32_t id);
+        Family &FamilyOf(uint32_t id);
+        size_t threads_;
+        // Both are numbered from 1, 0 is none. The numbers come from the
+        // shards, so some of them are unused.
+        std::vector<Individual> individuals_;
+        std::vector<Family> families_;
+        // The named individuals in the order of their INDI records.
+        std::vector<uint32_t> named_;
+        GedcomXrefs individual_xrefs_[kXrefShards];
+        GedcomXrefs family_xrefs_[kXrefShards];
+        // (family, individual) of FAMS and (individual, family) of CHIL,
+        // used when FAM has no HUSB or WIFE and INDI has no FAMC.
+        std::vector<std::pair<uint32_t, uint32_t> > spouse_links_;
+        std::vector<std::pair<uint32_t, uint32_t> > child_links_;
+        size_t bytes_;
+        size_t records_;
+        double parallel_seconds_;
+        int year_;
 };
 
 /**
- * Constructs empty linked list.
+ * Constructs importer with nothing read, which parses on `threads`
+ * threads.
  */
-FamilyLinkedList::FamilyLinkedList() {
-    head_ = NULL;
-    size_ = 0;
+GedcomImporter::GedcomImporter(size_t threads) {
+    Individual none = {kUnknownName, 0, 0, kGenderNotIdentified, false};
+    Family no_family = {0, 0};
+    threads_ = threads < 1 ? 1 : threads;
+    individuals_.push_back(none);
+    families_.push_back(no_family);
+    bytes_ = 0;
+    records_ = 0;
+    parallel_seconds_ = 0;
+    year_ = CurrentYear();
 }
 
 /**
- * Destructor for FamilyLinkedList.
+ * Returns the individual numbered `id`, adds the ones up to it if needed.
  */
-FamilyLinkedList::~FamilyLinkedList() {
-    while (head_ != NULL) {
-        FamilyNode *n = head_->next;
-        delete head_;
-        head_ = n;
+GedcomImporter::Individual &GedcomImporter::IndividualOf(uint32_t id) {
+    if (id >= individuals_.size()) {
+        individuals_.resize(id + 1, individuals_[0]);
     }
+    return individuals_[id];
 }
 
 /**
- * Returns the FamilyNode from the given `full_name`.
+ * Returns the family numbered `id`, adds the ones up to it if needed.
  */
-FamilyNode *FamilyLinkedList::Get(string full_name) {
-    if (head_ == NULL) {
-        return NULL;
-    }
-    FamilyNode *node = head_;
-    while (node != NULL) {
-        if (EqualsIgnoreCase(node->full_name(), full_name)) {
-            return node;
-        }
-        node = node->next;
+GedcomImporter::Family &GedcomImporter::FamilyOf(uint32_t id) {
+    if (id >= families_.size()) {
+        families_.resize(id + 1, families_[0]);
     }
-    // return NULL if full_name is not exist
-    return NULL;
+    return families_[id];
 }
 
 /**
- * Prints all of ancestors of the given `full_name`, `level` is used
- * for indicates the level of ancestors.
+ * Returns the shard of the cross reference `hash`.
  */
-void FamilyLinkedList::PrintAncestors(string full_name, int level) {
-    FamilyNode *person = Get(full_name);
-    // base case
-    if (person == NULL || full_name.compare(kNotIdentified) == 0) {
-        return;
-    }
-    FamilyNode *node = head_;
-
-    string prefix = "grand ";
-    int i;
-    // level - 1 because 1 level (grand father is not great-grand father)
-    for (i = 0; i < level - 1; i++) {
-        prefix = "great-" + prefix;
-    }
-    if (level == 0) {
-        prefix = "";
-    }
+inline uint32_t GedcomXrefShard(uint32_t hash) {
+    return hash % kXrefShards;
+}
 
-    // printf("L %d\n", level);
-    // Only father and mother is look up based on the member variable not the
-    // node in linked list.
-    if (person->father().compare(kNotIdentified) != 0) {
-        printf("%s, %sfather\n", person->father().c_str(), prefix.c_str());
-        PrintAncestors(person->father(), level + 1);
-    }
-    if (person->mother().compare(kNotIdentified) != 0) {
-        printf("%s, %smother\n", person->mother().c_str(), prefix.c_str());
-        PrintAncestors(person->mother(), level + 1);
-    }
+/**
+ * Returns the thread of `threads` which owns the name `hash`.
+ */
+inline size_t GedcomNameThread(uint32_t hash, size_t threads) {
+    return SlotOf(hash * kHashPrime, threads);
 }
 
 /**
- * Prints all of descendants of the given `full_name`, `level` is used
- * for indicates the level of descendants.
+ * Returns the handle of `name` of `length` bytes and FoldedHash `hash`
+ * if it is in the pool, or the index of its PendingName in `work` or'ed
+ * with kPendingName. Runs on the thread which owns `hash`.
  */
-void FamilyLinkedList::PrintDescendants(string full_name, int level) {
-    FamilyNode *person = Get(full_name);
-    FamilyNode *node = head_;
-    int counter = 0;
-    string prefix = "grand ";
-    int i;
-    // level -1 because 1 level is grand daughter or grand son
-    for (i = 0; i < level - 1; i++) {
-        prefix = "great-" + prefix;
+uint32_t GedcomImporter::LookupName(const char *name, size_t length,
+        uint32_t hash, ThreadWork *work) {
+    NameHandle folded;
+    NameHandle handle = name_pool.Lookup(name, length, hash, &folded);
+    if (handle != kUnknownName) {
+        return handle;
     }
-    if (level == 0) {
-        prefix = "";
+    std::vector<uint32_t> &slots = work->pending_slots;
+    size_t slot = SlotOf(hash, slots.size());
+    uint32_t folded_pending = kNoPendingName;
+    for (; slots[slot] != 0; slot = NextSlot(slot, slots.size())) {
+        const PendingName &other = work->pending[slots[slot] - 1];
+        if (other.hash != hash || other.length != length) {
+            continue;
+        }
+        if (memcmp(other.name, name, length) == 0) {
+            return (slots[slot] - 1) | kPendingName;
+        }
+        size_t i;
+        for (i = 0; i < length &&
+                FoldCase(other.name[i]) == FoldCase(name[i]); i++) {
+        }
+        if (i == length && folded_pending == kNoPendingName) {
+            folded_pending = slots[slot] - 1;
+        }
+    }
+    PendingName pending = {name, length, hash, folded, folded_pending,
+        kUnknownName, kUnknownName};
+    uint32_t index = work->pending.size();
+    work->pending.push_back(pending);
+    slots[slot] = index + 1;
+    if (work->pending.size() * 2 > slots.size()) {
+        std::vector<uint32_t> grown(slots.size() * 2, 0);
+        for (index = 0; index < work->pending.size(); index++) {
+            for (slot = SlotOf(work->pending[index].hash, grown.size());
+                    grown[slot] != 0; slot = NextSlot(slot, grown.size())) {
+            }
+            grown[slot] = index + 1;
+        }
+        slots.swap(grown);
     }
+    return (work->pending.size() - 1) | kPendingName;
+}
 
-    while (node != NULL) {
-        if (EqualsIgnoreCase(node->father(), full_name) ||
-            EqualsIgnoreCase(node->mother(), full_name)) {
-            if (EqualsIgnoreCase(node->sex(), kFemale)) {
-                printf("%s, %sdaughter\n", node->full_name().c_str(),
-                        prefix.c_str());
-            } else {
-                printf("%s, %sson\n", node->full_name().c_str(),
-                        prefix.c_str());
+/**
+ * Numbers the cross references and looks up the names of `chunks` which
+ * `thread` of `threads` owns. The pool is only read here.
+ */
+void GedcomImporter::Number(const std::vector<GedcomChunk> &chunks,
+        size_t thread, size_t threads, ThreadWork *work) {
+    work->pending_slots.assign(kInitialXrefSlots, 0);
+    size_t i;
+    for (i = 0; i < chunks.size(); i++) {
+        const GedcomChunk &chunk = chunks[i];
+        size_t j;
+        for (j = 0; j < chunk.xrefs.size(); j++) {
+            const GedcomXref &xref = chunk.xrefs[j];
+            uint32_t shard = GedcomXrefShard(xref.hash);
+            if (shard % threads != thread) {
+                continue;
             }
-            // print descendants recursively
-            PrintDescendants(node->full_name(), level + 1);
+            GedcomXrefs &xrefs = xref.is_family ? family_xrefs_[shard] :
+                individual_xrefs_[shard];
+            work->xref_ids.push_back(
+                    xrefs.Number(xref.text, xref.hash) * kXrefShards +
+                    shard + 1);
+        }
+        for (j = 0; j < chunk.records.size(); j++) {
+            const GedcomRecord &record = chunk.records[j];
+            if (record.is_family || !record.has_name ||
+                    record.name_size == 0 ||
+                    GedcomNameThread(record.name_hash, threads) != thread) {
+                continue;
+            }
+            work->names.push_back(LookupName(
+                        &chunk.names[record.name_offset], record.name_size,
+                        record.name_hash, work));
         }
-        node = node->next;
     }
 }
 
 /**
- * Prints siblings of `full_name`.
+ * Adds the pending `name` of `work` to the pool if it is not yet, and
+ * returns its handle. Runs on the main thread in the file order, so the
+ * pending name it folds into is added before.
  */
-void FamilyLinkedList::PrintSiblings(string full_name) {
-    FamilyNode *person = Get(full_name);
-    FamilyNode *node = head_;
+NameHandle GedcomImporter::AddName(PendingName *name, ThreadWork *work) {
+    if (name->handle != kUnknownName) {
+        return name->handle;
+    }
+    NameHandle folded = name->folded;
+    if (folded == kUnknownName && name->folded_pending != kNoPendingName) {
+        folded = work->pending[name->folded_pending].root;
+    }
+    name->handle = name_pool.Add(name->name, name->length, name->hash,
+            folded);
+    name->root = folded == kUnknownName ? name->handle : folded;
+    return name->handle;
+}
 
-    while (node != NULL) {
-        // Common father or mother
-        if ((EqualsIgnoreCase(node->father(), person->father()) ||
-             EqualsIgnoreCase(node->mother(), person->mother())) &&
-             !EqualsIgnoreCase(node->full_name(), person->full_name())) {
-            if (EqualsIgnoreCase(node->sex(), kFemale)) {
-                if (node->age() == person->age()) {
-                    printf("%s, sister [same age %d]\n",
-                            node->full_name().c_str(),
-                            person->age());
-                } else if (node->age() > person->age()) {
-                    printf("%s, elder sister\n",
-                            node->full_name().c_str());
-                } else {
-                    printf("%s, younger sister\n",
-                            node->full_name().c_str());
+/**
+ * Merges the records of `chunk` with what `works` of `threads` threads
+ * found for them.
+ */
+void GedcomImporter::Merge(GedcomChunk *chunk, size_t threads,
+        std::vector<ThreadWork> *works) {
+    size_t i;
+    chunk->xref_ids.resize(chunk->xrefs.size());
+    for (i = 0; i < chunk->xrefs.size(); i++) {
+        ThreadWork &work = (*works)[
+            GedcomXrefShard(chunk->xrefs[i].hash) % threads];
+        chunk->xref_ids[i] = work.xref_ids[work.xref_cursor++];
+    }
+    const std::vector<uint32_t> &ids = chunk->xref_ids;
+    for (i = 0; i < chunk->records.size(); i++) {
+        const GedcomRecord &record = chunk->records[i];
+        size_t j;
+        if (record.is_family) {
+            uint32_t family = ids[record.xref];
+            uint32_t husband = record.husband == kNoXref ? 0 :
+                ids[record.husband];
+            uint32_t wife = record.wife == kNoXref ? 0 : ids[record.wife];
+            IndividualOf(husband);
+            IndividualOf(wife);
+            FamilyOf(family).husband = husband;
+            FamilyOf(family).wife = wife;
+            for (j = record.links_begin; j < record.links_end; j++) {
+                uint32_t child = ids[chunk->links[j]];
+                IndividualOf(child);
+                child_links_.push_back(std::make_pair(child, family));
+            }
+        } else {
+            uint32_t individual = ids[record.xref];
+            uint32_t family = record.family == kNoXref ? 0 :
+                ids[record.family];
+            FamilyOf(family);
+            for (j = record.links_begin; j < record.links_end; j++) {
+                uint32_t spouse_family = ids[chunk->links[j]];
+                FamilyOf(spouse_family);
+                spouse_links_.push_back(
+                        std::make_pair(spouse_family, individual));
+            }
+            Individual &person = IndividualOf(individual);
+            if (record.has_name && record.name_size > 0) {
+                ThreadWork &work = (*works)[
+                    GedcomNameThread(record.name_hash, threads)];
+                uint32_t name = work.names[work.name_cursor++];
+                if (name & kPendingName) {
+                    name = AddName(&work.pending[name & ~kPendingName],
+                            &work);
                 }
-            } else {
-                if (node->age() == person->age()) {
-                    printf("%s, brother [same age %d]\n",
-                            node->full_name().c_str(),
-                            person->age());
-                } else if (node->age() > person->age()) {
-                    printf("%s, elder brother\n",
-                            node->full_name().c_str());
-                } else {
-                    printf("%s, younger brother\n",
-                            node->full_name().c_str());
+                if (person.name == kUnknownName) {
+                    named_.push_back(individual);
                 }
+                person.name = name;
+            }
+            person.family = family;
+            person.gender = record.gender;
+            person.is_name_only = record.is_name_only;
+            person.age = 0;
+            if (record.birth_year >= 0 && record.birth_year <= year_ &&
+                    year_ - record.birth_year <= kMaxAge) {
+                person.age = year_ - record.birth_year;
             }
         }
-        node = node->next;
     }
+    records_ += chunk->records.size();
 }
 
 /**
- * Adds person `p` to head of the linked list.
+ * Splits [`begin`, `end`) into chunks at record boundaries, parses and
+ * numbers them on the threads, then merges them.
  */
-void FamilyLinkedList::Add(Person p) {
-    FamilyNode *new_node = new FamilyNode;
-    new_node->person = p;
-    new_node->next = head_;
-    head_ = new_node;
-    size_++;
+void GedcomImporter::ParseBlock(const char *begin, const char *end) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    size_t threads = threads_;
+    size_t most_chunks = (end - begin) / kMinImportChunkSize + 1;
+    if (threads > most_chunks) {
+        threads = most_chunks;
+    }
+    std::vector<GedcomChunk> chunks;
+    const char *chunk_begin = begin;
+    size_t i;
+    for (i = 0; i < threads && chunk_begin < end; i++) {
+        GedcomChunk chunk;
+        chunk.begin = chunk_begin;
+        chunk.end = end;
+        if (i + 1 < threads) {
+            chunk.end = NextGedcomRecordStart(begin,
+                    begin + (end - begin) * (i + 1) / threads, end);
+        }
+        chunks.push_back(chunk);
+        chunk_begin = chunk.end;
+    }
+    std::vector<std::thread> workers;
+    for (i = 1; i < chunks.size(); i++) {
+        workers.push_back(std::thread(ParseGedcomChunk, &chunks[i]));
+    }
+    if (!chunks.empty()) {
+        ParseGedcomChunk(&chunks[0]);
+    }
+    for (i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+
+    // The pool is only read until the threads are joined.
+    std::vector<ThreadWork> works(threads);
+    for (i = 1; i < threads; i++) {
+        workers.push_back(std::thread(&GedcomImporter::Number, this,
+                    std::cref(chunks), i, threads, &works[i]));
+    }
+    Number(chunks, 0, threads, &works[0]);
+    for (i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    parallel_seconds_ += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+    size_t names = name_pool.size();
+    for (i = 0; i < threads; i++) {
+        works[i].xref_cursor = 0;
+        works[i].name_cursor = 0;
+        names += works[i].pending.size();
+    }
+    name_pool.Reserve(names);
+    for (i = 0; i < chunks.size(); i++) {
+        Merge(&chunks[i], threads, &works);
+    }
 }
 
 /**
- * Deletes `full_name` from the linked list and returns
- * the deleted person as a FamilyNode.
+ * Reads and parses the whole `file`, kImportBlockSize bytes at a time.
+ * The last record of a block is kept for the next one, since it may
+ * continue there.
+ * Returns false if the file cannot be read.
  */
-FamilyNode *FamilyLinkedList::Delete(string full_name) {
-    FamilyNode *return_node = NULL;
-    if (head_ == NULL) {
-        return return_node;
+bool GedcomImporter::Read(FILE *file) {
+    std::vector<char> block;
+    size_t used = 0;
+    bool is_end = false;
+    while (!is_end) {
+        if (block.size() < used + kImportBlockSize) {
+            block.resize(used + kImportBlockSize);
+        }
+        size_t length = fread(&block[used], 1, kImportBlockSize, file);
+        if (ferror(file)) {
+            return false;
+        }
+        bytes_ += length;
+        used += length;
+        is_end = length < kImportBlockSize;
+        const char *begin = &block[0];
+        const char *end = begin + used;
+        const char *last = is_end ? end : LastGedcomRecordStart(begin, end);
+        if (last == begin && !is_end) {
+            continue;  // One record is bigger than the block, read more.
+        }
+        ParseBlock(begin, last);
+        used = end - last;
+        memmove(&block[0], last, used);
     }
-    FamilyNode *current_node = head_->next;
-    FamilyNode *previous_node = head_;
-    FamilyNode *obsolete_node = new FamilyNode;
-    // head will be eliminated
-    if (previous_node != NULL &&
-            EqualsIgnoreCase(previous_node->person.full_name(), full_name)) {
-        head_ = previous_node->next;
-        obsolete_node = previous_node;
-        return_node = previous_node;
-        delete obsolete_node;
-        size_--;
-        return return_node;
+    return true;
+}
+
+/**
+ * Resolves the family links of the individuals to the names of their
+ * fathers and mothers, then appends one person for each named
+ * individual to `people`, in the order of the INDI records. The individuals
+ * marked _NAMEONLY only name a father or mother.
+ */
+void GedcomImporter::Resolve(std::vector<Person> *people) {
+    size_t i;
+    for (i = 0; i < spouse_links_.size(); i++) {
+        Family &family = families_[spouse_links_[i].first];
+        uint32_t spouse = spouse_links_[i].second;
+        if (family.husband == spouse || family.wife == spouse) {
+            continue;
+        }
+        if (individuals_[spouse].gender == kGenderMale &&
+                family.husband == 0) {
+            family.husband = spouse;
+        } else if (individuals_[spouse].gender == kGenderFemale &&
+                family.wife == 0) {
+            family.wife = spouse;
+        }
+    }
+    for (i = 0; i < child_links_.size(); i++) {
+        Individual &child = individuals_[child_links_[i].first];
+        if (child.family == 0) {
+            child.family = child_links_[i].second;
+        }
     }
+    spouse_links_.clear();
+    child_links_.clear();
 
-    while (current_node != NULL) {
-        if (EqualsIgnoreCase(current_node->person.full_name(), full_name)) {
-            obsolete_node = current_node;
-            return_node = current_node;
-            // last node will be eliminated
-            if (current_node->next == NULL) {
-                FamilyNode *temp_node = new FamilyNode;
-                // Searching for the node prior the tail
-                while (previous_node != current_node) {
-                    temp_node = previous_node;
-                    previous_node = previous_node->next;
-                }
-                temp_node->next = NULL;
-            } else {
-                // middle node will be eliminated
-                previous_node->next = current_node->next;
-            }
-            delete obsolete_node;
-            size_--;
-            return return_node;
+    // "not identified" stands for the parents who are unknown or unnamed.
+    individuals_[0].name = kNotIdentifiedName;
+    people->reserve(people->size() + named_.size());
+    for (i = 0; i < named_.size(); i++) {
+        Individual &individual = individuals_[named_[i]];
+        if (individual.name == kUnknownName || individual.is_name_only) {
+            continue;
         }
-        current_node = current_node->next;
-        previous_node = previous_node->next;
+        const Family &family = families_[individual.family];
+        NameHandle father = individuals_[family.husband].name;
+        NameHandle mother = individuals_[family.wife].name;
+        people->push_back(Person(individual.name, individual.age,
+                    individual.gender,
+                    father == kUnknownName ? kNotIdentifiedName : father,
+                    mother == kUnknownName ? kNotIdentifiedName : mother));
     }
-    return return_node;
+    individuals_[0].name = kUnknownName;
 }
 
 /**
- * Prints all nodes in the linked list.
+ * Returns the number of bytes read.
  */
-void FamilyLinkedList::PrintAllNodes() {
-    FamilyNode *node = head_;
-    if (size_ < 1) {
-        printf("[]\n");
-        return;
-    }
-    int i;
-    while (node != NULL) {
-        printf("%s\n", node->person.ToString().c_str());
-        node = node->next;
-    }
-    printf("Total: %d\n", size());
+size_t GedcomImporter::bytes() {
+    return bytes_;
 }
 
 /**
- * Prints all of the relative of `full_name`.
- * The person full_name=`full_name` must exists in the linked list.
+ * Returns the number of INDI and FAM records parsed.
  */
-void FamilyLinkedList::PrintRelativesOf(string full_name) {
-    printf("\n%s's relatives:\n\n", full_name.c_str());
-    PrintAncestors(full_name, 0);
-    PrintDescendants(full_name, 0);
-    PrintSiblings(full_name);
-    return;
+size_t GedcomImporter::records() {
+    return records_;
 }
 
 /**
- * Returns the current size of the linked list.
+ * Returns the number of threads which parse.
  */
-int FamilyLinkedList::size() {
-    return size_;
+size_t GedcomImporter::threads() {
+    return threads_;
+}
+
+/**
+ * Returns the seconds spent parsing and numbering on the threads, the
+ * rest of the import runs on the main thread.
+ */
+double GedcomImporter::parallel_seconds() {
+    return parallel_seconds_;
 }
 
 /**
@@ -563,6 +3102,7 @@ int FamilyLinkedList::size() {
  */
 void AddNewPerson(FamilyLinkedList *family_linked_list,
                   FamilyLinkedList *ghost_family_linked_list) {
+    STATS_TIME_COMMAND(kAddNewPerson);
     PrintHeader("Add new person");
     string full_name;
     string age;
@@ -571,7 +3111,7 @@ void AddNewPerson(FamilyLinkedList *family_linked_list,
     string father_full_name;
     string mother_full_name;
     printf("Please enter a name: ");
-    getline(cin, full_name);
+    ReadLine(full_name);
     if (EqualsIgnoreCase(full_name, "")) {
         printf("\nFull name cannot be null\n");
         return;
@@ -597,19 +3137,19 @@ void AddNewPerson(FamilyLinkedList *family_linked_list,
         return;
     }
     printf("Enter age: ");
-    getline(cin, age);
+    ReadLine(age);
     if (EqualsIgnoreCase(age, "")) {
         printf("\nAge cannot be null\n");
         return;
     }
     std::stringstream ss(age);
     ss >> age_value;
-    if (!ss) {
+    if (!ss || age_value < 0 || age_value > kMaxAge) {
         printf("\nInvalid age: %s\n", age.c_str());
         return;
     }
     printf("Gender:");
-    getline(cin, gender);
+    ReadLine(gender);
     Trim(gender);
     if (EqualsIgnoreCase(gender, "")) {
         printf("\nGender cannot be null\n");
@@ -621,9 +3161,9 @@ void AddNewPerson(FamilyLinkedList *family_linked_list,
         return;
     }
     printf("Father's name: ");
-    getline(cin, father_full_name);
+    ReadLine(father_full_name);
     printf("Mother's name: ");
-    getline(cin, mother_full_name);
+    ReadLine(mother_full_name);
 
     Person new_person(full_name, age_value, gender,
             father_full_name, mother_full_name);
@@ -637,17 +3177,18 @@ void AddNewPerson(FamilyLinkedList *family_linked_list,
  * Deletes the person from the main `family_linked_list`.
  */
 void DeletePerson(FamilyLinkedList *family_linked_list) {
+    STATS_TIME_COMMAND(kDeletePerson);
     PrintHeader("Delete person");
     string full_name;
     printf("\nPlease enter a name: ");
-    getline(cin, full_name);
+    ReadLine(full_name);
     SuperTrim(full_name);
     FamilyNode *node = family_linked_list->Get(full_name);
     if (node) {
         printf("\n%s\n\n", node->person.ToString().c_str());
         string confirm;
         printf("Area you sure to delete %s (y/n)", full_name.c_str());
-        getline(cin, confirm);
+        ReadLine(confirm);
         if (EqualsIgnoreCase(confirm, "y")) {
             family_linked_list->Delete(full_name);
             printf("%s has been deleted!\n", full_name.c_str());
@@ -665,10 +3206,11 @@ void DeletePerson(FamilyLinkedList *family_linked_list) {
  * `family_linked_list`.
  */
 void FindAndDisplayPerson(FamilyLinkedList *family_linked_list) {
+    STATS_TIME_COMMAND(kFindAndDisplayPerson);
     PrintHeader("Find and display person");
     string full_name;
     printf("\nPlease enter a name: ");
-    getline(cin, full_name);
+    ReadLine(full_name);
     printf("!%s\n", full_name.c_str());
     SuperTrim(full_name);
     printf("!%s\n", full_name.c_str());
@@ -684,10 +3226,11 @@ void FindAndDisplayPerson(FamilyLinkedList *family_linked_list) {
  * Shows all relatives of the persons from the main `family_linked_list`.
  */
 void ShowAllRelatives(FamilyLinkedList *ghost_family_linked_list) {
+    STATS_TIME_COMMAND(kShowAllRelatives);
     PrintHeader("Show all relatives");
     string full_name;
     printf("\nPlease enter a name: ");
-    getline(cin, full_name);
+    ReadLine(full_name);
     SuperTrim(full_name);
     FamilyNode *node = ghost_family_linked_list->Get(full_name);
     if (node) {
@@ -697,6 +3240,186 @@ void ShowAllRelatives(FamilyLinkedList *ghost_family_linked_list) {
     }
 }
 
+/**
+ * Exports the main `family_linked_list`, or a subtree of it, to a GEDCOM
+ * or a Graphviz DOT file.
+ */
+void ExportFamilyTree(FamilyLinkedList *family_linked_list) {
+    PrintHeader("Export family tree");
+    string format;
+    printf("Format (gedcom/dot): ");
+    ReadLine(format);
+    Trim(format);
+    bool is_gedcom = EqualsIgnoreCase(format, "gedcom");
+    if (!is_gedcom && !EqualsIgnoreCase(format, "dot")) {
+        printf("\nInvalid format: %s\n", format.c_str());
+        return;
+    }
+    string file_name;
+    printf("File name: ");
+    ReadLine(file_name);
+    Trim(file_name);
+    if (EqualsIgnoreCase(file_name, "")) {
+        printf("\nFile name cannot be null\n");
+        return;
+    }
+    string root_name;
+    printf("Root person (empty for the whole tree): ");
+    ReadLine(root_name);
+    SuperTrim(root_name);
+
+    ExportIndex index;
+    if (!CollectExport(family_linked_list, root_name, &index)) {
+        printf("\n%s does not exist in the Family Tree\n", root_name.c_str());
+        return;
+    }
+    FILE *file = fopen(file_name.c_str(), "w");
+    if (file == NULL) {
+        printf("\nCannot open %s\n", file_name.c_str());
+        return;
+    }
+    bool is_written;
+    {
+        BufferedWriter writer(file);
+        if (is_gedcom) {
+            ExportGedcom(&index, &writer);
+        } else {
+            ExportDot(&index, &writer);
+        }
+        is_written = writer.Flush();
+    }
+    if (fclose(file) != 0 || !is_written) {
+        printf("\nCannot write %s\n", file_name.c_str());
+        return;
+    }
+    printf("\nExported %zu people to %s\n", index.people.size(),
+            file_name.c_str());
+}
+
+/**
+ * Imports the people of a GEDCOM file to the main `family_linked_list`
+ * and the `ghost_family_linked_list`. People who already exist are
+ * skipped, and so are the later people with the same name. Deleted
+ * people come back to the main list only, their ghost record stays.
+ */
+void ImportGedcomFile(FamilyLinkedList *family_linked_list,
+                      FamilyLinkedList *ghost_family_linked_list) {
+    PrintHeader("Import GEDCOM file");
+    string file_name;
+    printf("File name: ");
+    ReadLine(file_name);
+    Trim(file_name);
+    if (EqualsIgnoreCase(file_name, "")) {
+        printf("\nFile name cannot be null\n");
+        return;
+    }
+    FILE *file = fopen(file_name.c_str(), "rb");
+    if (file == NULL) {
+        printf("\nCannot open %s\n", file_name.c_str());
+        return;
+    }
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    GedcomImporter importer(std::thread::hardware_concurrency());
+    bool is_read = importer.Read(file);
+    fclose(file);
+    if (!is_read) {
+        printf("\nCannot read %s\n", file_name.c_str());
+        return;
+    }
+    std::vector<Person> people;
+    importer.Resolve(&people);
+
+    std::vector<bool> is_taken(name_pool.size(), false);
+    FamilyNode *node;
+    for (node = family_linked_list->head_; node != NULL; node = node->next) {
+        is_taken[name_pool.Folded(node->person.full_name_handle())] = true;
+    }
+    size_t kept = 0;
+    size_t i;
+    for (i = 0; i < people.size(); i++) {
+        NameHandle name = name_pool.Folded(people[i].full_name_handle());
+        if (!is_taken[name]) {
+            is_taken[name] = true;
+            people[kept++] = people[i];
+        }
+    }
+    size_t skipped = people.size() - kept;
+    people.resize(kept);
+    // The deleted people are still in the ghost list and keep their
+    // record there, the same as AddNewPerson never adds them twice.
+    std::vector<bool> is_ghost(name_pool.size(), false);
+    for (node = ghost_family_linked_list->head_; node != NULL;
+            node = node->next) {
+        is_ghost[name_pool.Folded(node->person.full_name_handle())] = true;
+    }
+    std::vector<Person> ghost_people;
+    ghost_people.reserve(people.size());
+    for (i = 0; i < people.size(); i++) {
+        if (!is_ghost[name_pool.Folded(people[i].full_name_handle())]) {
+            ghost_people.push_back(people[i]);
+        }
+    }
+    family_linked_list->AddBatch(people);
+    ghost_family_linked_list->AddBatch(ghost_people);
+
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    double megabytes = importer.bytes() / 1e6;
+    if (seconds <= 0) {
+        seconds = 1e-9;
+    }
+    printf("\nImported %zu people, skipped %zu existing\n", kept, skipped);
+    printf("%.1f MB, %zu records in %.2f s: %.1f MB/s, %.0f records/s\n",
+            megabytes, importer.records(), seconds, megabytes / seconds,
+            importer.records() / seconds);
+    printf("Parsing threads: %zu, %.2f s on them\n", importer.threads(),
+            importer.parallel_seconds());
+}
+
+/**
+ * Shows the latency histogram and the lookup work per query
+ * of each command.
+ */
+void ShowStatistics() {
+    PrintHeader("Statistics");
+#ifdef FAMILY_TREE_STATS
+    const QueryCounters &counters = family_tree_stats.counters;
+    printf("Get calls: %llu, nodes visited: %llu, comparisons: %llu\n",
+            static_cast<unsigned long long>(counters.get_calls),
+            static_cast<unsigned long long>(counters.nodes_visited),
+            static_cast<unsigned long long>(counters.comparisons));
+    printf("Relatives cache hits: %llu, misses: %llu\n",
+            static_cast<unsigned long long>(counters.relatives_cache_hits),
+            static_cast<unsigned long long>(counters.relatives_cache_misses));
+    printf("Name pool: %zu names, %zu surnames, %zu bytes\n\n",
+            name_pool.size(), name_pool.surnames(), name_pool.bytes());
+    printf("%-10s %8s %10s %10s %10s %10s %10s %8s %10s %12s\n",
+            "command", "count", "mean(us)", "p50(us)", "p90(us)", "p99(us)",
+            "max(us)", "get/q", "nodes/q", "compares/q");
+    int i;
+    for (i = 0; i < kTimedCommandCount; i++) {
+        CommandStats &stats = family_tree_stats.commands[i];
+        uint64_t count = stats.latency.count();
+        double queries = count == 0 ? 1.0 : static_cast<double>(count);
+        printf("%-10s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f "
+                "%8.1f %10.1f %12.1f\n",
+                kTimedCommandNames[i],
+                static_cast<unsigned long long>(count),
+                stats.latency.mean() / 1000.0,
+                stats.latency.ValueAtPercentile(50.0) / 1000.0,
+                stats.latency.ValueAtPercentile(90.0) / 1000.0,
+                stats.latency.ValueAtPercentile(99.0) / 1000.0,
+                stats.latency.max() / 1000.0,
+                stats.work.get_calls / queries,
+                stats.work.nodes_visited / queries,
+                stats.work.comparisons / queries);
+    }
+#else
+    printf("Statistics are disabled, built with FAMILY_TREE_NO_STATS.\n");
+#endif
+}
+
 /**
  * Prints the main menu, read the menu input from user,
  * then returns the command code for
@@ -708,10 +3431,13 @@ int ReadMainPrompt() {
     printf("(D)elete an existing person\n");
     printf("(F)ind and display the details of a person\n");
     printf("show all (R)elatives of a person\n");
+    printf("show (S)tatistics\n");
+    printf("(E)xport the family tree\n");
+    printf("(I)mport a GEDCOM file\n");
     printf("(Q)uit the program\n");
     printf("\nPlease select an operation: ");
     string menu_input;
-    getline(cin, menu_input);
+    ReadLine(menu_input);
 
     if (EqualsIgnoreCase(menu_input, "a")) {
         return kAddNewPerson;
@@ -721,6 +3447,12 @@ int ReadMainPrompt() {
         return kFindAndDisplayPerson;
     } else if (EqualsIgnoreCase(menu_input, "r")) {
         return kShowAllRelatives;
+    } else if (EqualsIgnoreCase(menu_input, "s")) {
+        return kShowStatistics;
+    } else if (EqualsIgnoreCase(menu_input, "e")) {
+        return kExportFamilyTree;
+    } else if (EqualsIgnoreCase(menu_input, "i")) {
+        return kImportGedcomFile;
     } else if (EqualsIgnoreCase(menu_input, "q")) {
         return kQuitProgram;
     }
@@ -757,6 +3489,16 @@ int main(int argc, const char *argv[]) {
             case kShowAllRelatives:
                 ShowAllRelatives(&family_linked_list);
                 break;
+            case kShowStatistics:
+                ShowStatistics();
+                break;
+            case kExportFamilyTree:
+                ExportFamilyTree(&family_linked_list);
+                break;
+            case kImportGedcomFile:
+                ImportGedcomFile(&family_linked_list,
+                                 &ghost_family_linked_list);
+                break;
             case kQuitProgram:
                 is_done = true;
                 PrintHeader("Goodbye dude");
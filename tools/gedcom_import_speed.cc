@@ -0,0 +1,47 @@
+/**
+ * Imports a GEDCOM file on the given number of threads and prints how
+ * fast it was read, and how much of the time ran on the threads.
+ * Usage: gedcom_import_speed.o <GEDCOM file> [number of threads, 1 by
+ *                              default]
+ */
+#define main family_tree_main
+#include "../family_tree.cc"
+#undef main
+
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Usage: %s <GEDCOM file> [number of threads]\n", argv[0]);
+        return 1;
+    }
+    int threads = argc > 2 ? atoi(argv[2]) : 1;
+    if (threads <= 0) {
+        printf("Invalid number of threads: %s\n", argv[2]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    GedcomImporter importer(threads);
+    bool is_read = importer.Read(file);
+    fclose(file);
+    if (!is_read) {
+        printf("Cannot read %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<Person> people;
+    importer.Resolve(&people);
+    double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    double megabytes = importer.bytes() / 1e6;
+    printf("Threads: %d, %zu people in %.2f s, %.1f MB/s, "
+            "%.0f%% of the time on the threads\n", threads, people.size(),
+            seconds, megabytes / seconds,
+            100 * importer.parallel_seconds() / seconds);
+    return 0;
+}
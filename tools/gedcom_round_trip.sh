@@ -0,0 +1,75 @@
+#!/bin/sh
+# Exports people whose names need escaping in GEDCOM ("@" and "/"),
+# imports the file in a new session and checks that all of them come
+# back with the same details, and that the parents who are only named
+# are not added as people.
+# Usage: tools/gedcom_round_trip.sh [family tree program]
+
+program=${1:-./family_tree.o}
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+# name, age, gender, father's name, mother's name
+cat > "$dir/people" <<'EOF'
+Jo@n A/B|30|female||
+K/im @Lee|5|male|Jo@n A/B|
+Solo/@|7|male||
+Ann @@ Marie /Smith/|41|female||
+Plain Name|9|male|Solo/@|Ann @@ Marie /Smith/
+Kid Smith|3|male|Dad @Smith|Mom S/mith
+EOF
+
+# Parents who are not in the tree.
+cat > "$dir/name_only" <<'EOF'
+Dad @Smith
+Mom S/mith
+EOF
+
+# Prints the menu input which finds every person, then every parent
+# who is only named if `1` is given.
+find_all() {
+    while IFS='|' read -r name age gender father mother; do
+        printf 'f\n%s\n' "$name"
+    done < "$dir/people"
+    if [ "$1" = 1 ]; then
+        while read -r name; do
+            printf 'f\n%s\n' "$name"
+        done < "$dir/name_only"
+    fi
+}
+
+# Keeps the number of imported people and the result of every find.
+details() {
+    grep -e '^Imported ' -e ' years old, ' -e ' does not exist '
+}
+
+{
+    while IFS='|' read -r name age gender father mother; do
+        printf 'a\n%s\n%s\n%s\n%s\n%s\n' \
+            "$name" "$age" "$gender" "$father" "$mother"
+    done < "$dir/people"
+    find_all 0
+    printf 'e\ngedcom\n%s\n\nq\n' "$dir/tree.ged"
+} | "$program" | details > "$dir/exported"
+
+{
+    echo "Imported $(wc -l < "$dir/people") people, skipped 0 existing"
+    cat "$dir/exported"
+    while read -r name; do
+        echo "$name does not exist in the Family Tree"
+    done < "$dir/name_only"
+} > "$dir/expected"
+
+{
+    printf 'i\n%s\n' "$dir/tree.ged"
+    find_all 1
+    printf 'q\n'
+} | "$program" | details > "$dir/actual"
+
+if [ "$(wc -l < "$dir/exported")" -ne "$(wc -l < "$dir/people")" ] ||
+        ! cmp -s "$dir/expected" "$dir/actual"; then
+    echo "GEDCOM round trip failed:"
+    diff "$dir/expected" "$dir/actual"
+    exit 1
+fi
+echo "GEDCOM round trip passed"
@@ -0,0 +1,93 @@
+/**
+ * Builds a synthetic family tree and prints how much memory it takes,
+ * then writes it to a GEDCOM file if one is given.
+ * Every 8 people share a surname and have the first 2 people of the
+ * previous 8 as their father and mother.
+ * Usage: synthetic_tree.o [number of people, 1000000 by default]
+ *                         [GEDCOM file]
+ */
+#define main family_tree_main
+#include "../family_tree.cc"
+#undef main
+
+#include <stdlib.h>
+#include <malloc.h>
+
+const int kDefaultPeople = 1000000;
+const int kChildrenPerCouple = 8;
+
+/**
+ * Returns the name of person `i`.
+ */
+string SyntheticName(int i) {
+    char name[64];
+    snprintf(name, sizeof(name), "Given%d Surname%d", i,
+            i / kChildrenPerCouple);
+    return name;
+}
+
+int main(int argc, char **argv) {
+    int people = argc > 1 ? atoi(argv[1]) : kDefaultPeople;
+    if (people <= 0) {
+        printf("Invalid number of people: %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<string> names(people);
+    size_t name_bytes = 0;
+    int i;
+    for (i = 0; i < people; i++) {
+        names[i] = SyntheticName(i);
+        name_bytes += names[i].size();
+    }
+
+    struct mallinfo2 before = mallinfo2();
+    FamilyLinkedList family_linked_list;
+    for (i = 0; i < people; i++) {
+        int couple = (i / kChildrenPerCouple - 1) * kChildrenPerCouple;
+        bool has_parents = couple >= 0 && couple + 1 < people;
+        family_linked_list.Add(Person(names[i], i % 90,
+                    i % 2 ? kFemale : kMale,
+                    has_parents ? names[couple] : "",
+                    has_parents ? names[couple + 1] : ""));
+    }
+    struct mallinfo2 after = mallinfo2();
+    // Large blocks such as the name pool arrays are mmapped by malloc.
+    size_t heap = (after.uordblks + after.hblkhd) -
+        (before.uordblks + before.hblkhd);
+
+    printf("People: %d, sizeof(Person): %zu, sizeof(FamilyNode): %zu\n",
+            people, sizeof(Person), sizeof(FamilyNode));
+    printf("Heap growth: %.1f bytes/person, %.1f of them for the list\n",
+            static_cast<double>(heap) / people,
+            static_cast<double>(heap - name_pool.bytes()) / people);
+    printf("Name pool: %zu names, %zu surnames, %.1f bytes/person "
+            "for %.1f bytes/person of name text\n",
+            name_pool.size(), name_pool.surnames(),
+            static_cast<double>(name_pool.bytes()) / people,
+            static_cast<double>(name_bytes) / people);
+    printf("Beyond the name text: %.1f bytes/person\n",
+            static_cast<double>(heap - name_bytes) / people);
+    if (argc <= 2) {
+        return 0;
+    }
+
+    FILE *file = fopen(argv[2], "wb");
+    if (file == NULL) {
+        printf("Cannot open %s\n", argv[2]);
+        return 1;
+    }
+    ExportIndex index;
+    CollectExport(&family_linked_list, "", &index);
+    bool is_written;
+    {
+        BufferedWriter writer(file);
+        ExportGedcom(&index, &writer);
+        is_written = writer.Flush();
+    }
+    if (fclose(file) != 0 || !is_written) {
+        printf("Cannot write %s\n", argv[2]);
+        return 1;
+    }
+    printf("Wrote %zu people to %s\n", index.people.size(), argv[2]);
+    return 0;
+}